@@ -16,6 +16,20 @@
 #include "ADC_Setup.h"
 #include "Delay_Setup.h"
 
+/*************************************************
+*               Global Variables                 *
+*************************************************/
+extern volatile T16_FLAG FLAG1;
+
+//The last simultaneous AN0 - AN3 sample taken in the background, and a count
+//that increments each time a new sample is stored
+volatile UINT16 adc_sample[4];
+volatile UINT16 adc_sample_count = 0;
+
+//The sums of the conversions that are averaged into the next sample
+UINT16 adc_sum[4] = {0,0,0,0};
+UINT8 adc_sum_count = 0;
+
 /*******************************************************************************
 * Function: ADC_Init(void)                                              
 *                                                                              
@@ -94,9 +108,29 @@ UINT16 ADC_Read(void)
 * Description:                                                                 
 * This function will read the ADC value on whichever four ADC channels s=
 * simultaneously (AN0 - AN3). The data                                
+* 
+* If the ADC is converting in the background (see ADC_Start_Triggered()), this
+* function waits for the next background sample instead of starting one. These
+* are on the 11-bit scale (0 - ADC_SAMPLE_MAX).
 *******************************************************************************/
 void ADC_Read_SS(UINT16 *buf)
 {
+  UINT16 count;
+  
+  //The ADC is converting in the background, wait for the next sample
+  if (ADC_BACKGROUND)
+  {
+    count = adc_sample_count;
+    
+    while (count == adc_sample_count);
+    
+    buf[0] = adc_sample[0];
+    buf[1] = adc_sample[1];
+    buf[2] = adc_sample[2];
+    buf[3] = adc_sample[3];
+    return;
+  }
+  
   //Begin ADC sample
   _SAMP = 0;
   
@@ -113,4 +147,77 @@ void ADC_Read_SS(UINT16 *buf)
   buf[3] = ADC1BUF0; 
 }
 
+/*******************************************************************************
+* Function: ADC_Start_Triggered(void)                                                     
+*                                                                              
+* Variables:                                                                   
+* N/A                                                                          
+*                                                                              
+* Description:                                                                 
+* This function switches the ADC over to background sampling. Each Timer3 period
+* ends sampling and starts a simultaneous conversion of AN0 - AN3, after which
+* the ADC interrupt fires and sampling starts again on its own. The ADC interrupt
+* must call ADC_Store_Sample() to save the readings.
+*******************************************************************************/
+void ADC_Start_Triggered(void)
+{
+  _ADON = 0;
+  
+  //Simultaneous sampling, auto sample start, Timer3 ends sampling and starts
+  //the conversion
+  AD1CON1 = 0x004C;
+  
+  //Set priority to 6, above Timer1 (5) and the LED refresh (INT1, 4) so that
+  //no conversion is missed. Clear interrupt flag and enable interrupt
+  _AD1IP = 6;
+  _AD1IF = 0;
+  _AD1IE = 1;
+  
+  ADC_BACKGROUND = 1;
+  _ADON = 1;
+}
+
+/*******************************************************************************
+* Function: ADC_Store_Sample(void)                                                     
+*                                                                              
+* Variables:                                                                   
+* N/A                                                                          
+*                                                                              
+* Description:                                                                 
+* This function is called from the ADC interrupt and adds the last simultaneous
+* conversion of AN0 - AN3 to a running sum. Once ADC_OVERSAMPLE conversions have
+* been added up, the sum is rounded down to 11 bits (0 - ADC_SAMPLE_MAX) and saved
+* in 'adc_sample[4]' (in the same order as ADC_Read_SS(a)) and a 1 is returned. 
+* Otherwise it returns a 0.
+* 
+* Max sum = 1023 * ADC_OVERSAMPLE (4) = 4092
+* Max sample = (4092 + 1) >> ADC_SAMPLE_SHIFT (1) = 2046
+*******************************************************************************/
+UINT8 ADC_Store_Sample(void)
+{
+  adc_sum[0] += ADC1BUF1; 
+  adc_sum[1] += ADC1BUF2; 
+  adc_sum[2] += ADC1BUF3; 
+  adc_sum[3] += ADC1BUF0; 
+  
+  if (++adc_sum_count < ADC_OVERSAMPLE)
+    return 0;
+  
+  //Decimate the sums down to one 11-bit sample
+  adc_sample[0] = (adc_sum[0] + (1 << (ADC_SAMPLE_SHIFT - 1))) >> ADC_SAMPLE_SHIFT;
+  adc_sample[1] = (adc_sum[1] + (1 << (ADC_SAMPLE_SHIFT - 1))) >> ADC_SAMPLE_SHIFT;
+  adc_sample[2] = (adc_sum[2] + (1 << (ADC_SAMPLE_SHIFT - 1))) >> ADC_SAMPLE_SHIFT;
+  adc_sample[3] = (adc_sum[3] + (1 << (ADC_SAMPLE_SHIFT - 1))) >> ADC_SAMPLE_SHIFT;
+  
+  adc_sum[0] = 0;
+  adc_sum[1] = 0;
+  adc_sum[2] = 0;
+  adc_sum[3] = 0;
+  adc_sum_count = 0;
+  
+  adc_sample_count++;
+  
+  return 1;
+}
+
 #endif
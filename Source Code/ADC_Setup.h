@@ -48,6 +48,21 @@
 #define CHANNEL_AN30      30
 #define CHANNEL_AN31      31
 
+//Set while the ADC is converting AN0 - AN3 in the background (triggered by 
+//Timer3). ADC_Read_SS(a) then returns the next background sample.
+#define ADC_BACKGROUND    FLAG1.b12
+
+//The amount of conversions of AN0 - AN3 (4 or 16) that are added up into each
+//background sample. Timer3 triggers the ADC this many times faster so that a new
+//sample is still ready every 250us. Each 4x cuts the noise in half, which is one
+//more bit of resolution, so the background samples keep one extra bit and are
+//on a 0 - ADC_SAMPLE_MAX (11-bit) scale. At 16x the ADC interrupt runs every 
+//~16us, which takes a fair amount of CPU time.
+#define ADC_OVERSAMPLE        4
+#define ADC_OVERSAMPLE_SHIFT  2     //log2(ADC_OVERSAMPLE)
+#define ADC_SAMPLE_SHIFT      (ADC_OVERSAMPLE_SHIFT - 1)
+#define ADC_SAMPLE_MAX        2046
+
 /*************************************************
 *                   Macros                       *
 *************************************************/
@@ -58,6 +73,8 @@
 *************************************************/  
 void ADC_Init(void);     
 void ADC_Read_SS(UINT16 *buf);
+void ADC_Start_Triggered(void);
+UINT8 ADC_Store_Sample(void);
 
 UINT16 ADC_Read(void);   
    
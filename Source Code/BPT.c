@@ -41,6 +41,8 @@
 #include "LED_Control.h"
 #include "BT_Functions.h"
 #include "VU_Control.h"
+#include "Pod_History.h"
+#include "Spectrum.h"
 
 /*******************************************************************************
 * Function: main()                                                             * 
@@ -55,6 +57,11 @@
 int main(void)
 {   
   UINT16 buf[7];
+  UINT8 spectrum[SPECTRUM_COLUMNS] = {0};
+  UINT8 frame;
+  UINT8 vu_mode = 0;
+  UINT16 vsync = 0;
+  UINT32 band_time;
   
   UINT32 bw_bits;
   UINT32 tmark = 0;
@@ -86,6 +93,9 @@ int main(void)
   
   //Prepare the LED grid to start receiving data
   HC595_Init();
+  
+  //Clear the grid layers that are composited on top of the animations
+  Layer_Init();
 
   //Configure the TLC5955 for operation
   TLC5955_Default_Init(TLC5955_DSPRPT_ON);
@@ -100,8 +110,23 @@ int main(void)
   //Prepare the ADC to read 4 channels at a time, starting on channel 3
   ADC_CHANNEL(3);
   
-  //Calibrate the IR sensors
-  Sensor_Calibration();
+  //Reset the MSGEQ7 so that its bands are read in order
+  MSGEQ7_Init();
+  
+  //Start reading the IR sensors (and the MSGEQ7) in the background
+  IR_Start_Acquisition();
+
+  //Copy the audio conversions into the spectrum analyzer's buffers by DMA
+  if (SPECTRUM_ENABLE)
+    Spectrum_Init();
+  
+  //Gate the IR transmitters so that the pods and room light are subtracted out
+  IR_Lock_In(ON);
+  
+  //Use the calibration that was saved in the EEPROM. If it isn't valid anymore,
+  //calibrate the IR sensors in the background over the first couple of seconds
+  if (IR_Load_Calibration() != IR_CAL_SUCCESS)
+    Sensor_Calibration();
 
 	//Turn on the underlighting
 	RGB_Underlighting(COLOR[GREEN]);
@@ -153,6 +178,9 @@ int main(void)
     {
 	    //Retrieve the IR sensor readings
       IR_sensors = Update_All_Sensors();         
+      
+      //Add any cup changes to the history of the pods
+      Pod_History_Update();
     
 	    //Mask off the bits that aren't needed for the ball washer IR sensors
 	    bw_bits = (IR_sensors >> 20);
@@ -186,30 +214,73 @@ int main(void)
 	    else
 	    {
 			  //Read all 7 frequency bands from the MSGEQ7
-			  MSGEQ7_Read(buf);
+			  band_time = MSGEQ7_Read(buf);
 			    
+			  //Let the VU director pick the mode to suit the music
+			  if (VU_AUTO)
+			  	VU_Meter = VU_Director(VU_Meter);
+			  
+			  //Each VU mode spreads the levels over its own dynamic range
+			  if (VU_Meter != vu_mode)
+			  {
+			  	vu_mode = VU_Meter;
+			  	MSGEQ7_Set_Range(VU_Range(vu_mode));
+			  }
+			  
 			  //Adjust each reading by accounting for offset
 		    MSGEQ7_Auto_Adjust(buf,VU_signal);			    
 		    
+		    //Follow the tempo of the music with the animation clock
+		    MSGEQ7_Tempo(VU_signal);
+		    
+		    //Smooth the levels and move the peaks by the time since the last reading
+		    VU_Update(VU_signal,band_time,VU_display);
+		    
+		    //Only draw the VU animations once for each frame the grid shows
+		    frame = Grid_VSync(&vsync);
+		    
 		    //Display the selected VU animations
 		    switch (VU_Meter)
 		    {
 			    case 2:
-		    					Grid_VU_Mode1(VU_signal[0]);
-		   						Pods_VU_Mode1(VU_signal);
-	                Cycle_Ring_Animations();
+			    				if (frame)
+			    				{
+		    						Grid_VU_Mode1(VU_display[0]);
+		   							Pods_VU_Mode1(VU_display);
+		   						}
+		   						
+		   						//Flash the LED rings with the beats
+	                Rings_VU_Mode1(VU_display);
 			    	 			break;
 			    	 			
 			    case 3: 
-		    					Grid_VU_Mode2(VU_signal);
+			    				if (frame)
+		    						Grid_VU_Mode2(VU_display);
+		    						
 				          Cycle_Pod_Animations();
 	                Cycle_Ring_Animations();
-		   						//Pods_VU_Mode2(VU_signal[0]);
+		   						//Pods_VU_Mode2(VU_display[0]);
 		   						break;
 		   						
 			    case 4: 
-			    				Bargraph_Update(VU_signal[0]);
-		   						Pods_VU_Mode2(VU_signal[0]);
+			    				if (frame)
+			    				{
+			    					Bargraph_Update(VU_display[0],VU_Peak(0));
+		   							Pods_VU_Mode2(VU_display[0]);
+		   						}
+		   						
+		   						Rings_VU_Mode1(VU_display);
+			    				break;
+			    				
+			    //Spectrum analyzer, only reached with SPECTRUM_ENABLE set
+			    case 5:
+			    				if (Spectrum_Update(spectrum))
+			    					Grid_Spectrum(spectrum);
+			    				
+			    				if (frame)	
+		   							Pods_VU_Mode1(VU_display);
+		   							
+	                Cycle_Ring_Animations();
 			    				break;
 
 			    
@@ -230,9 +301,14 @@ int main(void)
 * Description:                                                                  
 * This interrupt controls the RGB pods and their updates. It has a period of                                                                               
 * 8192uS, updating the pods with a refresh rate of ~120Hz.                                                                              
+* The ADC interrupt has a higher priority and keeps running during the ~1ms
+* TLC5955 write.
 *******************************************************************************/
 void __attribute__((__interrupt__, __auto_psv__)) _T1Interrupt(void)
 {
+  //Switch the IR transmitters when lock-in detection is used
+  IR_Gate();
+  
   //Check to see if any TLC channels (pods, LED rings, etc) need to be updated
   if (TLC5955_UPDATE)
   {
@@ -240,6 +316,9 @@ void __attribute__((__interrupt__, __auto_psv__)) _T1Interrupt(void)
     TLC5955_Write_GS(TLC_data2);
     TLC5955_UPDATE = 0;
   } 
+  
+  //The IR transmitters have now been switched, let the IR sensors know
+  IR_Gate_Latched();
  
  //Clear the TMR1 interrupt flag
  _T1IF = 0;
@@ -252,19 +331,13 @@ void __attribute__((__interrupt__, __auto_psv__)) _T1Interrupt(void)
 * N/A                                                                           
 *                                                                               
 * Description:                                                                  
-* This timer is set to interrupt every ~1ms and controls the fading of the RGB                                                                               
-* pods, as well as the operation of any scrolling text.                                                                              
+* Timer3 triggers the ADC conversions for the IR sensors every 250us / 
+* ADC_OVERSAMPLE. Its interrupt is not enabled and is only here as a blank 
+* template in case anyone wants to use it.                                                                              
 *******************************************************************************/
 void __attribute__((__interrupt__, __auto_psv__)) _T3Interrupt(void)
 { 
-  //Check to see if any TLC channels are fading (RGB pods, rings, etc)
-  Fade_State(); 
-   
-  //If text is scrolling across the LED grid, update the scroll operation 
-  if (SCROLL_ACTIVE)
-    scroll_status = Update_Text();
- 
- //Clear the TMR3 interrupt flag   
+//TMR3 interrupt is not used; May be needed for future implementation
  _T3IF = 0;
 }
 
@@ -291,8 +364,10 @@ void __attribute__((__interrupt__, __auto_psv__)) _T4Interrupt(void)
 * N/A                                                                           
 *                                                                               
 * Description:                                                                  
-* This timer has the highest priority and interrupts in 1ms intervals. It keeps                                                                              
-* track of the global counting variable as well as refreshing the LED grid.                                                                              
+* This timer has the highest priority and interrupts in 1ms intervals. It only
+* keeps track of the global counting variable and the animation clock, so that
+* it never holds up the ADC interrupt for long. The rest of the 1ms work is 
+* handed to the INT1 interrupt, which runs below the ADC.
 *******************************************************************************/
 void __attribute__((__interrupt__, __auto_psv__)) _T5Interrupt(void)
 { 
@@ -301,10 +376,69 @@ void __attribute__((__interrupt__, __auto_psv__)) _T5Interrupt(void)
 	//operation
   count32++;
   
+  //Advance the animation clock, which follows the tempo of the music
+  Anim_Clock_Tick();
+  
+  //Run the LED refresh in the INT1 interrupt
+  _INT1IF = 1;
+  
+ _T5IF = 0;
+}
+
+/*******************************************************************************
+* Function: External Interrupt #1                                                                      
+*                                                                               
+* Variables:                                                                    
+* N/A                                                                           
+*                                                                               
+* Description:                                                                  
+* INT1 isn't connected to a pin, it is set by Timer5 every 1ms. It refreshes the
+* LED grid and controls the fading of the RGB pods and the operation of any 
+* scrolling text. Its priority (4) is below the ADC (6) so that no conversions 
+* are missed while the pods are fading, and below Timer1 (5) so that the 
+* TLC5955 data can't change while it is being written.
+*******************************************************************************/
+void __attribute__((__interrupt__, __auto_psv__)) _INT1Interrupt(void)
+{ 
+  _INT1IF = 0;
+  
+  //Check to see if any TLC channels are fading (RGB pods, rings, etc)
+  Fade_State(); 
+   
+  //If text is scrolling across the LED grid, update the scroll operation 
+  if (SCROLL_ACTIVE)
+    scroll_status = Update_Text();
+  
   //Refresh the LED grid
   Grid_Control();
+}
+
+/*******************************************************************************
+* Function: ADC Interrupt                                                                     
+*                                                                               
+* Variables:                                                                    
+* N/A                                                                           
+*                                                                               
+* Description:                                                                  
+* This interrupt is called each time the ADC finishes a background conversion
+* of AN0 - AN3 (triggered by Timer3). Every ADC_OVERSAMPLE conversions (250us)
+* it stores the averaged readings, moves the IR sensor multiplexers on to the
+* next input and steps the MSGEQ7 through its frequency bands. The spectrum
+* analyzer doesn't use this interrupt, its samples are copied by DMA.
+*******************************************************************************/
+void __attribute__((__interrupt__, __auto_psv__)) _AD1Interrupt(void)
+{
+  //Add up the AN0 - AN3 readings. Once enough have been averaged, store the IR
+  //sensor readings and select the next multiplexer input
+  if (ADC_Store_Sample())
+  {
+    IR_Acquire();
+    
+    //Step the MSGEQ7 through its frequency bands
+    MSGEQ7_Acquire();
+  }  
   
- _T5IF = 0;
+  _AD1IF = 0;
 }
 
 /*******************************************************************************
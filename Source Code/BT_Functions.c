@@ -25,6 +25,8 @@
 #include "Interrupts.h"
 #include "SD_Setup.h"
 #include "FAT32_Setup.h"
+#include "IR_Sensors.h"
+#include "Pod_History.h"
 #include <string.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -40,6 +42,9 @@ extern volatile UINT16 IR_value[24];
 
 extern volatile UINT32 IR_sensors;
 
+extern volatile UINT32 IR_health;
+extern UINT8 IR_fault[24];
+
 extern volatile RGB COLOR[11];
 extern volatile T16_FLAG FLAG1;
 
@@ -114,6 +119,9 @@ UINT8 Receive_Buffer_Size(UINT8 *data)
 	  case BT_GRID_CONTROL: 			return BT_GRID_CONTROL_RX_BUF; 				break;
 	  
 	  case BT_TEST_IR_VALUES: 	return BT_TEST_IR_VALUES_RX_BUF; 			break;
+	  case BT_POD_EVENTS: 			return BT_POD_EVENTS_RX_BUF; 					break;
+	  case BT_SENSOR_HEALTH: 		return BT_SENSOR_HEALTH_RX_BUF; 			break;
+	  case BT_POD_HISTORY: 			return BT_POD_HISTORY_RX_BUF; 				break;
 	  
 	  case BT_ACTIVE: 						return BT_ACTIVE_RX_BUF;  break;
 	  case BT_STANDBY: 						return BT_STANDBY_RX_BUF;  break;
@@ -152,6 +160,9 @@ UINT8 Check_UART_Command(UINT8 *data)
 	  case BT_GRID_CONTROL: BT_Update_LED_Grid(&data[2]); break;
 	  
 	  case BT_TEST_IR_VALUES: 	BT_IR_Sensor_Data(); 			break;
+	  case BT_POD_EVENTS: 			BT_Pod_Events(); 					break;
+	  case BT_SENSOR_HEALTH: 		BT_Sensor_Health(); 			break;
+	  case BT_POD_HISTORY: 			Pod_History_Print(); 			break;
 	  
 	  case BT_ACTIVE: MODE_STANDBY = OFF; break;
 	  
@@ -225,11 +236,78 @@ void BT_IR_Sensor_Data(void)
 		printf("Adjusted Level: %d\r\n",diff);
 		Delay_ms(1);
 		
+		printf("Threshold: %u\r\n",IR_Threshold(i));
+		Delay_ms(1);
+		
 		printf("Detection State: %s\r\n\r\n",state);
 		Delay_ms(1);
 	}	
 }	
 
+/*******************************************************************************
+* Function: BT_Pod_Events(void)                                                                
+*                                                                             
+* Variables:
+* N/A                                                                                                                                           
+*                                                                             
+* Description:           
+* Sends every cup and ball washer change that has happened since the last time
+* this command was received, along with the time (count32) that it happened at.
+* Up to IR_EVENT_SIZE changes are kept between requests.
+*******************************************************************************/  
+void BT_Pod_Events(void)
+{
+	static UINT16 events = 0;
+	IR_EVENT event;
+	
+	while (IR_Event_Read(&events,&event))
+	{
+		if (event.sensor < 20)
+			printf("Pod #%d ",event.sensor + 1);
+		else
+			printf("IR Ballwasher Sensor #%d ",event.sensor - 19);
+			
+		if (event.state == IR_EVENT_ADDED)
+			printf("Added @ %lums\r\n",event.time);
+		else
+			printf("Removed @ %lums\r\n",event.time);
+			
+		Delay_ms(1);
+	}	
+}	
+
+/*******************************************************************************
+* Function: BT_Sensor_Health(void)                                                                
+*                                                                             
+* Variables:
+* N/A                                                                                                                                           
+*                                                                             
+* Description:           
+* Sends the health bitmap of the IR sensors (bit 0 = Pod #1 ... bit 23 = the
+* last ball washer sensor, a 1 = faulty and ignored) followed by the faults that
+* were found on each faulty sensor. See IR_Health_Update().
+*******************************************************************************/  
+void BT_Sensor_Health(void)
+{
+	UINT8 i;
+	
+	printf("Sensor Health: %06lX\r\n",IR_health);
+	Delay_ms(1);
+	
+	for (i = 0;i < 24;i++)
+	{
+		if (IR_fault[i] == 0)
+			continue;
+			
+		printf("Sensor #%d:%s%s%s%s\r\n",i+1,
+		       (IR_fault[i] & IR_FAULT_STUCK) ? " Stuck" : "",
+		       (IR_fault[i] & IR_FAULT_SATURATED) ? " Saturated" : "",
+		       (IR_fault[i] & IR_FAULT_NOISY) ? " Noisy" : "",
+		       (IR_fault[i] & IR_FAULT_FLIPPING) ? " Flipping" : "");
+		Delay_ms(1);
+	}	
+}	
+
 /*******************************************************************************
 * Function: Check_UART_Command(char str[32])                                                                   
 *                                                                             
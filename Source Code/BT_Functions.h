@@ -64,6 +64,9 @@
 #define BT_FACTORY_RESET								0x0024
 #define BT_ENUMERATE_SD									0x0025
 #define BT_SD_CARD_SPECS								0x0026
+#define BT_POD_EVENTS										0x0027
+#define BT_SENSOR_HEALTH								0x0028
+#define BT_POD_HISTORY									0x0029
 			
 #define BT_ACTIVE												0x002E
 #define BT_STANDBY											0x002F
@@ -73,6 +76,9 @@
 //Receive buffer sizes; The amount of bytes to be passed after the initial command
 #define BT_GRID_CONTROL_RX_BUF  				48     
 #define BT_TEST_IR_VALUES_RX_BUF	 			0    
+#define BT_POD_EVENTS_RX_BUF			 			0    
+#define BT_SENSOR_HEALTH_RX_BUF		 			0    
+#define BT_POD_HISTORY_RX_BUF			 			0    
 #define BT_ACTIVE_RX_BUF					 			0    
 #define BT_STANDBY_RX_BUF					 			0      
 
@@ -85,6 +91,8 @@ void Pod_Help_Menu(void);
 void Pixel_Help_Menu(void);
 void EEPROM_Help_Menu(void);
 void BT_IR_Sensor_Data(void);
+void BT_Pod_Events(void);
+void BT_Sensor_Health(void);
 void Clear_UART_String(void);
 void LED_Ring_Help_Menu(void);
 
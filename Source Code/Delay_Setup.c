@@ -10,14 +10,18 @@
 * time.                                                                        
 *******************************************************************************/
 
-#ifndef DELAY_SETUP_H
-#define DELAY_SETUP_H
+#ifndef DELAY_SETUP_C
+#define DELAY_SETUP_C
 
 #include "Main_Includes.h"
 #include "Delay_Setup.h"
 
 //Must be declared in global variables
 extern volatile UINT32 count32;
+extern volatile UINT32 anim_count;
+extern volatile UINT16 anim_rate;
+extern volatile UINT16 anim_period;
+extern volatile UINT8 anim_beat;
 
 /*******************************************************************************
 * Function: Time_Check(UINT32 *mark, UINT16 interval)                           
@@ -53,4 +57,117 @@ UINT8 Time_Check(UINT32 *mark, UINT16 interval)
   return 0;
 }
 
+/*******************************************************************************
+* Function: Anim_Check(UINT32 *mark, UINT16 interval)                           
+*                                                                              
+* Variables:                                                                   
+* mark -> Stores the animation clock value from when the interval started                                                                     
+* interval -> The amount of animation clock ticks to wait for                                                                 
+*                                                                              
+* Description:                                                                 
+* This function works the same way as Time_Check(a,b), but uses 'anim_count'
+* instead of 'count32'. Animations that are timed with this function speed up
+* and slow down with the tempo of the music in VU mode. When no music is being
+* detected, 1 tick is 1ms and this function behaves exactly like Time_Check(a,b).
+* The static variable that *mark points to must be set from anim_count, not 
+* count32.                                                                             
+*******************************************************************************/
+UINT8 Anim_Check(UINT32 *mark, UINT16 interval) 
+{
+  //Check to see if the required amount of ticks has elapsed
+  if ((anim_count - *mark) >= interval)
+  {
+    *mark = anim_count;
+    return 1;  
+  }  
+  
+  //The required time has not elapsed, return a 0
+  return 0;
+}
+
+/*******************************************************************************
+* Function: Anim_Clock_Tick(void)                           
+*                                                                              
+* Variables:                                                                   
+* N/A                                                                 
+*                                                                              
+* Description:                                                                 
+* This function advances the animation clock and must be called from the 1ms
+* timer interrupt. The clock advances by 'anim_rate' (8.8 fixed point) every ms.
+* Whenever a beat is reported (anim_beat = 1, with the beat period in ms stored
+* in anim_period), the rate is set so that one beat lasts ANIM_BEAT_TICKS, and
+* the phase of the clock is pulled towards the nearest beat boundary by speeding
+* up or slowing down the clock for a short time. The clock never runs backwards.                                                                             
+*******************************************************************************/
+void Anim_Clock_Tick(void)
+{
+  static UINT16 fraction = 0;
+  static INT32 slew = 0;
+  static UINT32 beat_mark = 0;
+  INT16 step;
+  UINT16 phase;
+  UINT32 rate;
+  
+  //A new beat has been detected, lock the clock to it
+  if (anim_beat)
+  {
+    anim_beat = 0;
+    beat_mark = count32;
+    
+    if (anim_period)
+    {
+      rate = ((UINT32) ANIM_BEAT_TICKS << 8) / anim_period;
+      
+      if (rate < ANIM_RATE_MIN)
+        rate = ANIM_RATE_MIN;
+      else if (rate > ANIM_RATE_MAX)
+        rate = ANIM_RATE_MAX;
+        
+      anim_rate = rate;
+    }
+    
+    //Find how far the clock is from the closest beat boundary. Correct half 
+    //of the error, the next beats will take care of the rest.
+    phase = anim_count % ANIM_BEAT_TICKS;
+    
+    if (phase < (ANIM_BEAT_TICKS / 2))
+      slew = -(((INT32) phase) << 7);
+    else
+      slew = ((INT32) (ANIM_BEAT_TICKS - phase)) << 7;
+  }
+  
+  //The music has stopped, go back to real time
+  else if ((count32 - beat_mark) > ANIM_BEAT_TIMEOUT)
+  {
+    anim_rate = ANIM_RATE_REAL;
+    slew = 0;
+  }  
+  
+  //Apply the phase correction a bit at a time, at most a quarter of the
+  //current rate each ms
+  step = anim_rate;
+  
+  if (slew > (anim_rate >> 2))
+  {
+    step += anim_rate >> 2;
+    slew -= anim_rate >> 2;
+  }
+  
+  else if (slew < -((INT32) (anim_rate >> 2)))
+  {
+    step -= anim_rate >> 2;
+    slew += anim_rate >> 2;
+  }
+  
+  else
+  {
+    step += slew;
+    slew = 0;
+  }            
+  
+  fraction += step;
+  anim_count += fraction >> 8;
+  fraction &= 0x00FF;
+}
+
 #endif
@@ -7,7 +7,7 @@
 * Description:                                                                 
 * This source file contains two types of delays: a delay for milliseconds and  
 * a delay for microseconds. This also contains Time_Check(***) which is used for
-* interrupt timing.                                                   
+* interrupt timing, and the animation clock which follows the tempo of the music.
 *******************************************************************************/
 #ifndef DELAY_SETUP_H
 #define DELAY_SETUP_H
@@ -16,6 +16,20 @@
 #define Delay_ms(x) __delay32(((x*FCYC)/1000L)) 
 #include <libpic30.h>
 
+//The animation clock ticks ANIM_BEAT_TICKS times per beat of the music. With no
+//music it runs at the same speed as count32 (1 tick per ms, or 120 BPM).
+#define ANIM_BEAT_TICKS       500
+
+//Animation clock speeds, in 8.8 fixed point (256 = 1 tick per ms)
+#define ANIM_RATE_REAL        256
+#define ANIM_RATE_MIN         128
+#define ANIM_RATE_MAX         512
+
+//If no beat has been detected for this many ms, return to real time
+#define ANIM_BEAT_TIMEOUT     4000
+
 UINT8 Time_Check(UINT32 *mark, UINT16 interval);
+UINT8 Anim_Check(UINT32 *mark, UINT16 interval);
+void Anim_Clock_Tick(void);
 
 #endif
@@ -205,4 +205,37 @@ UINT8 EEPROM_Status(void)
   return response;
 } 
   
+/*******************************************************************************
+* Function: EEPROM_CRC(UINT8 *buf, UINT16 len)                                                                   
+*                                                                              
+* Variables:                                                                   
+* *buf -> The data to calculate the CRC of
+* len ->  The amount of bytes in the buffer     
+*                                                                      
+* Description:                                                                 
+* This function calculates the 16-bit CRC (CRC-16-CCITT) of a buffer. It is
+* stored along with records that are saved in the EEPROM so that a record that
+* was never written, or was only partly written, is not used.
+*******************************************************************************/
+UINT16 EEPROM_CRC(UINT8 *buf, UINT16 len)
+{
+  UINT8 i;
+  UINT16 crc = EEPROM_CRC_INIT;
+  
+  while (len--)
+  {
+    crc ^= (UINT16) (*buf++) << 8;
+    
+    for (i = 0;i < 8;i++)
+    {
+      if (crc & 0x8000)
+        crc = (crc << 1) ^ EEPROM_CRC_POLY;
+      else
+        crc <<= 1;
+    }    
+  }
+  
+  return crc;
+}
+
 #endif
@@ -52,6 +52,11 @@
 //Used in various functions to determine a successful operation
 #define EEPROM_SUCCESS        		0x00
 
+//Starting value and polynomial of the CRC used to check records in the EEPROM
+//(CRC-16-CCITT)
+#define EEPROM_CRC_INIT       		0xFFFF
+#define EEPROM_CRC_POLY       		0x1021
+
 /*************************************************
 *              Function Prototypes               *
 *************************************************/
@@ -60,6 +65,7 @@ void EEPROM_Command(UINT8 cmd);
 void EEPROM_Read(UINT16 addr, UINT8 *buf, UINT16 len);
 
 UINT8 EEPROM_Status(void);
+UINT16 EEPROM_CRC(UINT8 *buf, UINT16 len);
 UINT8 EEPROM_Write(UINT16 addr, UINT8 *buf, UINT16 len);
 
 #endif
@@ -27,6 +27,23 @@ extern UINT8 _FAR SD_buf[SD_BUF_SIZE];
 extern volatile FILE_SYSTEM FAT32;
 extern volatile T16_FLAG FLAG1;
 
+//The FAT sector cache (emptied by FAT32_Init()). fat_cache_used holds the value of
+//fat_cache_tick from the last time each sector was used, so the least recently
+//used one can be replaced.
+UINT8 _FAR fat_cache[FAT_CACHE_SIZE][SD_SECTOR_SIZE];
+UINT32 fat_cache_sector[FAT_CACHE_SIZE];
+UINT16 fat_cache_used[FAT_CACHE_SIZE];
+UINT8 fat_cache_dirty[FAT_CACHE_SIZE];
+UINT16 fat_cache_tick = 0;
+
+//The run of free clusters found by the last search of the FAT. It is used up as
+//the clusters are allocated, so most allocations do not search the FAT at all.
+UINT32 fat_free_start = 0;
+UINT32 fat_free_count = 0;
+
+//Set when the free cluster count or hint have changed and FSInfo needs updating
+UINT8 fat_fsinfo_dirty = 0;
+
 /*******************************************************************************
 * Function: FAT32_Init(void)                                                                   
 *                                                                              
@@ -40,11 +57,23 @@ extern volatile T16_FLAG FLAG1;
 UINT8 FAT32_Init(void)
 { 
   UINT8 response;
+  UINT8 i;
+  UINT32 clusters;
   char format[6] = "FAT32";
   
   //Start sector of the partition
   FAT32.partition_start = 0;
   
+  //Forget any FAT sectors cached from a previous card
+  for (i = 0;i < FAT_CACHE_SIZE;i++)
+  {
+    fat_cache_sector[i] = FAT_CACHE_EMPTY;
+    fat_cache_dirty[i] = 0;
+  }
+  
+  fat_free_count = 0;
+  fat_fsinfo_dirty = 0;
+  
   //Read the MBR
   response = SD_Read_Sector(0,SD_buf);
   
@@ -92,9 +121,45 @@ UINT8 FAT32_Init(void)
   //Calculate the total amount of write-able clusters on the SD card
   FAT32.total_clusters = FAT32.sectors_FAT * 128;
   
+  //The last sector of the FAT can have entries past the end of the partition;
+  //Only count the clusters that are really there
+  clusters = COMBINE32(SD_buf[35],SD_buf[34],SD_buf[33],SD_buf[32]);
+  clusters = ((clusters - (FAT32.root_start - FAT32.partition_start)) / FAT32.sectors_cluster) + 2;
+  
+  if (clusters < FAT32.total_clusters)
+    FAT32.total_clusters = clusters;
+  
   //Calculate the total amount of clusters on the SD card
   FAT32.card_capacity = SD_Capacity();
   
+  //Find the FSInfo sector
+  FAT32.fsinfo_sector = COMBINE16(SD_buf[49],SD_buf[48]) + FAT32.partition_start;
+  FAT32.free_clusters = FSINFO_UNKNOWN;
+  FAT32.next_free = 2;
+  
+  //Read the free cluster count and the next free hint if the FSInfo sector is valid
+  response = SD_Read_Sector(FAT32.fsinfo_sector,SD_buf);
+  
+  if (response || (COMBINE32(SD_buf[3],SD_buf[2],SD_buf[1],SD_buf[0]) != FSINFO_LEAD_SIG) ||
+     (COMBINE32(SD_buf[487],SD_buf[486],SD_buf[485],SD_buf[484]) != FSINFO_STRUCT_SIG))
+  {
+    //No FSInfo; The free clusters will be counted when they are needed
+    FAT32.fsinfo_sector = 0;
+  }
+  
+  else
+  {
+    FAT32.free_clusters = COMBINE32(SD_buf[491],SD_buf[490],SD_buf[489],SD_buf[488]);
+    FAT32.next_free = COMBINE32(SD_buf[495],SD_buf[494],SD_buf[493],SD_buf[492]);
+    
+    //The values are only hints; Don't use them if they are out of range
+    if (FAT32.free_clusters > FAT32.total_clusters)
+      FAT32.free_clusters = FSINFO_UNKNOWN;
+    
+    if ((FAT32.next_free < 2) || (FAT32.next_free >= FAT32.total_clusters))
+      FAT32.next_free = 2;
+  }
+  
   //Operation completed successfully
   return FAT32_SUCCESS;
 } 
@@ -235,10 +300,12 @@ UINT8 FAT32_Open_File(char filename[13], SD_FILE *FILE1)
 }  
 
 /*******************************************************************************
-* Function: FAT32_Read_File(SD_FILE *FILE1)                                                                   
+* Function: FAT32_Read_File(SD_FILE *FILE1, UINT8 *buf, UINT16 buf_size)                                                                   
 *                                                                              
 * Variables:                                                                   
 * *FILE1 -> Contains the file structure information of the file to be read                                                                         
+* *buf -> The buffer where the file data will be stored
+* buf_size -> The size of the buffer in bytes (multiple of 512)
 *                                                                              
 * Description:                                                                 
 * This function will read all of the data from the SD_FILE structure that is passed                                                                             
@@ -247,9 +314,14 @@ UINT8 FAT32_Open_File(char filename[13], SD_FILE *FILE1)
 * READ_IN_PROGRESS value. This will allow the user to parse the received buffer data
 * and then run the function again, doing this until a FAT32_SUCCESS value is returned,
 * indicating that all of the file has been read. The buffer size must be in multiples
-* of 512 bytes, as whole sectors are read into the buffer.                                                                             
+* of 512 bytes, as whole sectors are read into the buffer.
+*
+* The sectors are read in runs with one multiple block read (CMD18) each, so the
+* command overhead is paid once per run instead of once per sector. A run is as
+* long as the room left in the buffer and the file allow, and carries on into the
+* next cluster when it directly follows the current one on the card.                                                                             
 *******************************************************************************/
-UINT8 FAT32_Read_File(SD_FILE *FILE1)
+UINT8 FAT32_Read_File(SD_FILE *FILE1, UINT8 *buf, UINT16 buf_size)
 {
   static UINT32 last_sector;
   static UINT32 last_cluster;
@@ -259,9 +331,13 @@ UINT8 FAT32_Read_File(SD_FILE *FILE1)
   UINT32 next_sector;
   UINT32 next_cluster;
   UINT32 file_left;
+  UINT32 cluster_left;
+  UINT32 sectors_left;
+  UINT32 run;
+  UINT32 room;
+  UINT32 cluster;
   
   UINT8 response;
-  UINT8 cluster_left;
   UINT16 bc = 0;
   
   //Function was paused so that user could unload full buffer
@@ -297,40 +373,12 @@ UINT8 FAT32_Read_File(SD_FILE *FILE1)
     file_left = FILE1->size;
   }  
   
-  //Begin reading every sector/cluster of data until the EOF is reached  
-  do
+  //Begin reading every run of sectors until the EOF is reached  
+  while (file_left > 0)
   { 
     //Save the location of the last cluster that contains data (When loop is finished,
     //this variable will contain the last cluster location
     FILE1->last_cluster = next_cluster;
-      
-    //If all of the data has been read, return a successful read
-    if (file_left == 0)
-    {
-      //Clear pause bit
-      FAT32_PAUSE = 0;
-      
-      //End of file; Return success
-      return FAT32_SUCCESS;
-    }  
-    
-    //If the file data is less than or equal to a full sector,
-    //read the sector and return a successful read
-    else if (file_left <= FAT32.sector_size)
-    {
-      //Read last sector of data
-      response = SD_Read_Sector(next_sector,&SD_buf[bc]);
-          
-      //If there was a read error, return error
-      if (response)
-        return response; 
-      
-      //Clear pause bit
-      FAT32_PAUSE = 0;
-      
-      //End of file; Return succesful read
-      return FAT32_SUCCESS;
-    }
     
     //Check if we have read all of the sectors in the cluster
     if (cluster_left == 0x00)
@@ -340,40 +388,66 @@ UINT8 FAT32_Read_File(SD_FILE *FILE1)
       
       //If the End of File has been reached, return a successful read
       if (next_cluster >= 0x0FFFFFF8)
-      {
-        //Clear pause bit
-        FAT32_PAUSE = 0;
-        
-        //End of file; Return success
-        return FAT32_SUCCESS;
-      }  
+        break;
+      
+      //A 0 is returned on a read error
+      if (next_cluster == 0x00000000)
+        return SD_READ_ERROR;
       
       //Calculate the next sector that needs to be read    
       next_sector = ((next_cluster - 2) * FAT32.sectors_cluster ) + FAT32.root_start;
       
       //Reset the cluster counter so that all the sectors in the new cluster will be read
       cluster_left = FAT32.sectors_cluster;
+      
+      FILE1->last_cluster = next_cluster;
     }
+    
+    //Find the amount of sectors left in the file and the room left in the buffer
+    sectors_left = (file_left + FAT32.sector_size - 1) / FAT32.sector_size;
+    room = (buf_size - bc) / FAT32.sector_size;
+    
+    if (room > sectors_left)
+      room = sectors_left;
+    
+    //While the run reaches the end of the cluster and the next cluster is the
+    //next one on the card, carry the run on into it
+    while (cluster_left < room)
+    {
+      cluster = FAT32_Next_Cluster(next_cluster);
+      
+      if (cluster != (next_cluster + 1))
+        break;
+      
+      next_cluster = cluster;
+      cluster_left += FAT32.sectors_cluster;
+      FILE1->last_cluster = next_cluster;
+    }
+    
+    run = (cluster_left < room) ? cluster_left : room;
   
-    //Read the next sector of data 
-    response = SD_Read_Sector(next_sector,&SD_buf[bc]);
+    //Read the run of sectors
+    response = SD_Read_Mul_Sectors(next_sector,run,&buf[bc]);
      
     //If there was a read error, return error
     if (response)
       return response; 
     
     //Update the buffer location
-    bc += FAT32.sector_size;  
+    bc += run * FAT32.sector_size;  
     
     //Decrease the file size by the amount of data that was just read
-    file_left -= FAT32.sector_size;
+    if (run >= sectors_left)
+      file_left = 0;
+    else
+      file_left -= run * FAT32.sector_size;
     
     //Update the next sector address and the amount of sectors still left to read
-    next_sector++;
-    cluster_left--;
+    next_sector += run;
+    cluster_left -= run;
     
     //Check to see if our buffer has filled up; If it has, set a flag and pause reading
-    if (bc >= SD_BUF_SIZE)
+    if ((file_left > 0) && ((buf_size - bc) < FAT32.sector_size))
     {
       //Pause reading here; set a flag to use the received data before overwriting it
       FAT32_PAUSE = 1;
@@ -388,7 +462,6 @@ UINT8 FAT32_Read_File(SD_FILE *FILE1)
       return READ_IN_PROGRESS;
     }
   }
-  while (file_left > 0);  
 
   //Clear pause bit
   FAT32_PAUSE = 0;
@@ -499,6 +572,13 @@ UINT8 FAT32_Write_File(char filename[13],UINT32 filesize)
   SD_Write_Mul_Sectors(((last_cluster-2)*8) + FAT32.root_start,FAT32.sectors_cluster);
   //SD_Write_Sector(((last_cluster-2)*8) + FAT32.root_start,SD_buf);
   
+  //Write the new cluster chain into the FAT before the directory entry points to it
+  response = FAT32_Cache_Flush();
+  
+  //If there was a write error, return error
+  if (response)
+    return response; 
+  
   //The first sector of the directory entry is the root start (In the loop
   //below, loc++ is incremented at the beginning of the loop, hence the - 1)
   loc = FAT32.root_start - 1;
@@ -550,6 +630,12 @@ UINT8 FAT32_Write_File(char filename[13],UINT32 filesize)
           
         response = FAT32_Write_FAT(cluster,FAT32_EOF);  
          
+        //If there was a write error, return error
+        if (response)
+          return response; 
+          
+        response = FAT32_Cache_Flush();
+         
         //If there was a write error, return error
         if (response)
           return response; 
@@ -651,23 +737,41 @@ UINT8 FAT32_Write_File(char filename[13],UINT32 filesize)
 *                                                                              
 * Description:                                                                 
 * This function will get the total amount of free clusters that are available to                                                                            
-* write and return the amount.                                                                              
+* write and return the amount. The count from the FSInfo sector is used and kept
+* up to date as clusters are allocated. If the card has no valid count, the free
+* clusters in the FAT are counted once.                                                                              
 *******************************************************************************/
 UINT32 FAT32_Total_Free_Clusters(void)
 {
-  UINT8 buf[512];
-  UINT8 response;
-  UINT32 free_clusters;
+  UINT8 slot;
+  UINT16 j;
+  UINT32 i;
+  UINT32 free_clusters = 0;
   
-  //Read the boot sector which contains the free cluster amount
-  response = SD_Read_Sector(FAT32.partition_start+1,buf);
-     
-  //If there was a read error, return 0 clusters available
-  if (response)
-    return 0x00000000; 
+  //Return the known amount of free clusters
+  if (FAT32.free_clusters != FSINFO_UNKNOWN)
+    return FAT32.free_clusters;
   
-  //Get the amount of free clusters
-  free_clusters = COMBINE32(buf[491],buf[490],buf[489],buf[488]);
+  //Count every unused cluster entry in the FAT; Clusters 0 & 1 are reserved
+  for (i = 2;i < FAT32.total_clusters;i++)
+  {
+    j = (i % 128) * 4;
+    
+    //Get the sector of the FAT at the start and at the end of each sector
+    if ((i == 2) || (j == 0))
+    {
+      //If there was a read error, return 0 clusters available
+      if (FAT32_Cache_Read(FAT32.start_FAT + (i >> 7),&slot))
+        return 0x00000000;
+    }
+    
+    if ((COMBINE32(fat_cache[slot][j+3],fat_cache[slot][j+2],fat_cache[slot][j+1],fat_cache[slot][j]) & 0x0FFFFFFF) == 0)
+      free_clusters++;
+  }  
+  
+  //Keep the count and write it into FSInfo on the next flush
+  FAT32.free_clusters = free_clusters;
+  fat_fsinfo_dirty = 1;
   
   //Return the total amount of free clusters
   return free_clusters;
@@ -684,11 +788,11 @@ UINT32 FAT32_Total_Free_Clusters(void)
 *******************************************************************************/
 UINT32 FAT32_Next_Cluster(UINT32 cluster)
 {
-  UINT8 buf[512];
+  UINT8 slot;
   UINT8 response;
   UINT32 next_cluster;
   UINT32 FAT_sector;
-  UINT8 el;
+  UINT16 el;
   
   //Get sector location that conatins the next cluster info
   FAT_sector = (cluster & 0x0FFFFF80) >> 7;
@@ -696,15 +800,15 @@ UINT32 FAT32_Next_Cluster(UINT32 cluster)
   //Get the entry location for the next cluster; 4-Bytes to each entry
   el = (cluster & 0x7F) * 4;
   
-  //Read the sector of the FAT that contain the cluster entry
-  response = SD_Read_Sector(FAT32.start_FAT + FAT_sector,buf);
+  //Get the sector of the FAT that contain the cluster entry
+  response = FAT32_Cache_Read(FAT32.start_FAT + FAT_sector,&slot);
      
   //Read Error; Return 0 which is a reserved cluster, so we know its an error
   if (response)
     return 0x00000000; 
   
   //Store the next cluster data
-  next_cluster = COMBINE32(buf[el+3],buf[el+2],buf[el+1],buf[el]);
+  next_cluster = COMBINE32(fat_cache[slot][el+3],fat_cache[slot][el+2],fat_cache[slot][el+1],fat_cache[slot][el]);
   
   //return the next cluster
   return next_cluster;
@@ -721,32 +825,19 @@ UINT32 FAT32_Next_Cluster(UINT32 cluster)
 *******************************************************************************/
 UINT32 FAT32_Last_Cluster(UINT32 cluster)
 {
-  UINT8 buf[512];
-  UINT8 response;
-  UINT32 last_cluster;
-  UINT32 FAT_sector;
-  UINT8 el;
+  UINT32 last_cluster = cluster;
   
   //Loop until EOF has been found
   while (cluster != FAT32_EOF)
   {
-    //Get sector location that conatins the next cluster info
-    FAT_sector = (cluster & 0x0FFFFF80) >> 7;
-    
-    //Get the entry location for the next cluster; 4-Bytes to each entry
-    el = (cluster & 0x7F) * 4;
+    last_cluster = cluster;
     
-    //Read the sector of the FAT that contain the cluster entry
-    response = SD_Read_Sector(FAT32.start_FAT + FAT_sector,buf);
+    //Get the next cluster in the chain
+    cluster = FAT32_Next_Cluster(cluster);
        
     //Read Error; Return 0 which is a reserved cluster, so we know its an error
-    if (response)
+    if (cluster == 0x00000000)
       return 0x00000000; 
-      
-    last_cluster = cluster;
-    
-    //Store the next cluster data
-    cluster = COMBINE32(buf[el+3],buf[el+2],buf[el+1],buf[el]);
   }  
   
   //return the next cluster
@@ -796,41 +887,66 @@ UINT16 FAT32_Get_Offset(UINT32 filesize, UINT16 buf_size)
 * Description:                                                                 
 * This function will search the File Allocation Table and return the next free
 * cluster that is available. If no clusters are available, it will return a card                                                                             
-* full error (0).                                                                              
+* full error (0). The cluster is not allocated until it is written with
+* FAT32_Write_FAT().
+*
+* The search starts at the next free hint (from FSInfo) instead of cluster 2 and
+* wraps around to the start of the FAT. The whole run of free entries that is
+* found in that FAT sector is kept, and the next calls return clusters from it
+* without reading the FAT until it has been used up.                                                                              
 *******************************************************************************/
 UINT32 FAT32_Next_Free_Cluster(void)
 {
-  UINT8 buf[512];
-  UINT16 loc = 0;
+  UINT8 slot;
   UINT16 j;
   UINT32 i;
+  UINT32 n;
   UINT32 entry;
   
-  //Read the starting sector of the FAT where we will begin looking for unused clusters
-  SD_Read_Sector(FAT32.start_FAT,buf);
+  //Use the rest of the last run of free clusters that was found
+  if (fat_free_count)
+    return fat_free_start;
   
-  //Loop until a cluster is found or the card is deemed full; Clusters 0 & 1 are reserved
-  for (i = 2;i < FAT32.total_clusters;i++)
+  i = FAT32.next_free;
+  
+  //Check every cluster once, starting at the hint; Clusters 0 & 1 are reserved
+  for (n = 2;n < FAT32.total_clusters;n++,i++)
   {
+    //Wrap around to the start of the FAT
+    if (i >= FAT32.total_clusters)
+      i = 2;
+      
     //Calculate the next cluster entry position to read
     j = (i % 128) * 4;
     
-    //Check to see if we have reached the end of the sector
-    if ((i % 128) == 0)
+    //Get the sector of the FAT at the start, after wrapping and at the end of each sector
+    if ((n == 2) || (i == 2) || (j == 0))
     {
-      //Increment the sector location
-      loc++;
-      
-      //Read the next sector in the FAT
-      SD_Read_Sector(FAT32.start_FAT + loc,buf);
+      //If there was a read error, we can not tell which clusters are free
+      if (FAT32_Cache_Read(FAT32.start_FAT + (i >> 7),&slot))
+        return FAT32_CARD_FULL;
     }
     
     //Get the 32-bit cluster entry  
-    entry = COMBINE32(buf[j+3],buf[j+2],buf[j+1],buf[j]);
+    entry = COMBINE32(fat_cache[slot][j+3],fat_cache[slot][j+2],fat_cache[slot][j+1],fat_cache[slot][j]);
     
-    //If the cluster entry is equal to 0,that cluster is unused. Return unused cluster  
+    //If the cluster entry is equal to 0,that cluster is unused
     if ((entry & 0x0FFFFFFF) == 0)
-        return i;   
+    {
+      //Keep the run of free clusters that starts here (up to the end of the sector)
+      fat_free_start = i;
+      fat_free_count = 0;
+      
+      do
+      {
+        fat_free_count++;
+        j += 4;
+      } while ((j < SD_SECTOR_SIZE) && ((i + fat_free_count) < FAT32.total_clusters) &&
+              ((COMBINE32(fat_cache[slot][j+3],fat_cache[slot][j+2],fat_cache[slot][j+1],fat_cache[slot][j]) & 0x0FFFFFFF) == 0));
+      
+      //Return unused cluster
+      return i;
+    }
   }  
   
   //No free cluster was found, the card must be full          
@@ -847,14 +963,16 @@ UINT32 FAT32_Next_Free_Cluster(void)
 * Description:                                                                 
 * This function will locate a cluster in the FAT and write the data vvariable                                                                             
 * into it. The data variable should be the next cluster for the file or an EOF
-* marker.                                                                              
+* marker. The change is made in the FAT cache and is written to the card by
+* FAT32_Cache_Flush().                                                                              
 *******************************************************************************/
 UINT8 FAT32_Write_FAT(UINT32 cluster, UINT32 data)
 {
-  UINT8 buf[512];
+  UINT8 slot;
   UINT8 response;
   
-  UINT16 sector;
+  UINT32 old;
+  UINT32 sector;
   UINT16 offset; 
   
   //Calculate the sector location of the cluster entry
@@ -863,28 +981,223 @@ UINT8 FAT32_Write_FAT(UINT32 cluster, UINT32 data)
   //Calculate the offset where the cluster entry begins in the sector
   offset = (cluster & 0x0000007F) * 4;
   
-  //Read the whole sector
-  response = SD_Read_Sector(sector,buf);
+  //Get the whole sector
+  response = FAT32_Cache_Read(sector,&slot);
      
-  //If there was a write error, return error
+  //If there was a read error, return error
   if (response)
     return response; 
   
+  //Get the old entry to keep the free cluster count up to date
+  old = COMBINE32(fat_cache[slot][offset+3],fat_cache[slot][offset+2],fat_cache[slot][offset+1],fat_cache[slot][offset]) & 0x0FFFFFFF;
+  
+  //A free cluster is being allocated
+  if ((old == 0) && ((data & 0x0FFFFFFF) != 0))
+  {
+    if ((FAT32.free_clusters != FSINFO_UNKNOWN) && FAT32.free_clusters)
+      FAT32.free_clusters--;
+    
+    //Take the cluster out of the run of free clusters
+    if (fat_free_count && (cluster >= fat_free_start) && (cluster < (fat_free_start + fat_free_count)))
+    {
+      //Normally the first cluster of the run is used; Otherwise only keep the
+      //part of the run before the cluster
+      if (cluster == fat_free_start)
+      {
+        fat_free_start++;
+        fat_free_count--;
+      }
+      
+      else
+        fat_free_count = cluster - fat_free_start;
+    }
+    
+    //The next search starts after the last allocated cluster
+    FAT32.next_free = ((cluster + 1) < FAT32.total_clusters) ? (cluster + 1) : 2;
+    fat_fsinfo_dirty = 1;
+  }
+  
+  //A cluster is being freed
+  else if ((old != 0) && ((data & 0x0FFFFFFF) == 0))
+  {
+    if (FAT32.free_clusters != FSINFO_UNKNOWN)
+      FAT32.free_clusters++;
+      
+    fat_fsinfo_dirty = 1;
+  }
+  
   //Modify the four bytes pertaining to the cluster entry
-  buf[offset+3] = data >> 24;
-  buf[offset+2] = (data & 0x00FF0000) >> 16;
-  buf[offset+1] = (data & 0x0000FF00) >> 8;
-  buf[offset] = data & 0x000000FF;
+  fat_cache[slot][offset+3] = data >> 24;
+  fat_cache[slot][offset+2] = (data & 0x00FF0000) >> 16;
+  fat_cache[slot][offset+1] = (data & 0x0000FF00) >> 8;
+  fat_cache[slot][offset] = data & 0x000000FF;
+  
+  //The sector has to be written back to the card
+  fat_cache_dirty[slot] = 1;
+    
+  return FAT32_SUCCESS;
+}  
+
+/*******************************************************************************
+* Function: FAT32_Cache_Read(UINT32 sector, UINT8 *slot)                                                                    
+*                                                                              
+* Variables:                                                                   
+* sector -> The sector of the FAT that is needed
+* *slot -> Returns the entry of fat_cache[] that holds the sector
+*                                                                              
+* Description:                                                                 
+* This function will find a FAT sector in the cache. If it is not there, the
+* least recently used entry is written back (if it was changed) and the sector
+* is read from the card into it. Walking a cluster chain then only reads each
+* FAT sector once instead of once per cluster.                                                                              
+*******************************************************************************/
+UINT8 FAT32_Cache_Read(UINT32 sector, UINT8 *slot)
+{
+  UINT8 i;
+  UINT8 oldest = 0;
+  UINT8 response;
   
-  //Write the modified values back into the sector along with the other stored data
-  response = SD_Write_Sector(sector,buf);
+  fat_cache_tick++;
+  
+  //Look for the sector in the cache
+  for (i = 0;i < FAT_CACHE_SIZE;i++)
+  {
+    if (fat_cache_sector[i] == sector)
+    {
+      fat_cache_used[i] = fat_cache_tick;
+      *slot = i;
+      return FAT32_SUCCESS;
+    }
+  }
+  
+  //Not cached; Use an empty entry or the one that was used the longest time ago
+  for (i = 0;i < FAT_CACHE_SIZE;i++)
+  {
+    if (fat_cache_sector[i] == FAT_CACHE_EMPTY)
+    {
+      oldest = i;
+      break;
+    }
+    
+    if ((UINT16)(fat_cache_tick - fat_cache_used[i]) > (UINT16)(fat_cache_tick - fat_cache_used[oldest]))
+      oldest = i;
+  }
+  
+  //Write the old sector back to the card before replacing it
+  if (fat_cache_dirty[oldest])
+  {
+    response = FAT32_Cache_Write(oldest);
+    
+    //If there was a write error, return error
+    if (response)
+      return response; 
+  }
+  
+  fat_cache_sector[oldest] = FAT_CACHE_EMPTY;
+  
+  //Read the sector into the cache
+  response = SD_Read_Sector(sector,fat_cache[oldest]);
      
-  //If there was a write error, return error
+  //If there was a read error, return error
   if (response)
     return response; 
+  
+  fat_cache_sector[oldest] = sector;
+  fat_cache_used[oldest] = fat_cache_tick;
+  *slot = oldest;
+  
+  return FAT32_SUCCESS;
+}
+
+/*******************************************************************************
+* Function: FAT32_Cache_Write(UINT8 slot)                                                                    
+*                                                                              
+* Variables:                                                                   
+* slot -> The entry of fat_cache[] that is to be written
+*                                                                              
+* Description:                                                                 
+* This function will write a cached FAT sector back to the card, into the same
+* sector of every copy of the FAT.                                                                              
+*******************************************************************************/
+UINT8 FAT32_Cache_Write(UINT8 slot)
+{
+  UINT8 i;
+  UINT8 response;
+  
+  for (i = 0;i < FAT32.FAT_copies;i++)
+  {
+    response = SD_Write_Sector(fat_cache_sector[slot] + (i * FAT32.sectors_FAT),fat_cache[slot]);
+     
+    //If there was a write error, return error
+    if (response)
+      return response; 
+  }
+  
+  fat_cache_dirty[slot] = 0;
+  
+  return FAT32_SUCCESS;
+}
+
+/*******************************************************************************
+* Function: FAT32_Cache_Flush(void)                                                                    
+*                                                                              
+* Variables:                                                                   
+* N/A
+*                                                                              
+* Description:                                                                 
+* This function will write every changed FAT sector in the cache back to the
+* card, followed by the free cluster count and next free hint in the FSInfo
+* sector. It must be called once the FAT has been changed and before the card is
+* removed or powered off. The FSInfo sector is read and written through SD_buf,
+* so anything in SD_buf is lost.                                                                              
+*******************************************************************************/
+UINT8 FAT32_Cache_Flush(void)
+{
+  UINT8 i;
+  UINT8 response;
+  
+  for (i = 0;i < FAT_CACHE_SIZE;i++)
+  {
+    if (fat_cache_dirty[i])
+    {
+      response = FAT32_Cache_Write(i);
+     
+      //If there was a write error, return error
+      if (response)
+        return response; 
+    }
+  }
+  
+  //Update FSInfo if the free clusters have changed (and the card has FSInfo)
+  if (fat_fsinfo_dirty && FAT32.fsinfo_sector)
+  {
+    response = SD_Read_Sector(FAT32.fsinfo_sector,SD_buf);
+     
+    //If there was a read error, return error
+    if (response)
+      return response; 
+    
+    SD_buf[491] = FAT32.free_clusters >> 24;
+    SD_buf[490] = (FAT32.free_clusters & 0x00FF0000) >> 16;
+    SD_buf[489] = (FAT32.free_clusters & 0x0000FF00) >> 8;
+    SD_buf[488] = FAT32.free_clusters & 0x000000FF;
+    
+    SD_buf[495] = FAT32.next_free >> 24;
+    SD_buf[494] = (FAT32.next_free & 0x00FF0000) >> 16;
+    SD_buf[493] = (FAT32.next_free & 0x0000FF00) >> 8;
+    SD_buf[492] = FAT32.next_free & 0x000000FF;
     
+    response = SD_Write_Sector(FAT32.fsinfo_sector,SD_buf);
+     
+    //If there was a write error, return error
+    if (response)
+      return response; 
+  }
+  
+  fat_fsinfo_dirty = 0;
+  
   return FAT32_SUCCESS;
-}  
+}
 
 /*******************************************************************************
 * Function: FAT32_Display_MBR(FILE_SYSTEM *FS)                                                                   
@@ -909,6 +1222,8 @@ void FAT32_Display_MBR(FILE_SYSTEM *FS)
   printf("Root Start: %lu \r\n",FS->root_start);
   printf("Total Sectors: %lu \r\n",FS->total_sectors);
   printf("Total Clusters: %lu \r\n",FS->total_clusters);
+  printf("Free Clusters: %lu \r\n",FS->free_clusters);
+  printf("Next Free: %lu \r\n",FS->next_free);
   printf("Capacity: %lu \r\n",FS->card_capacity);
   printf("Signature: 0x%X \r\n",FS->signature);
   printf("Partition Start: %.4X \r\n",FS->partition_start);
@@ -35,6 +35,18 @@
 			
 #define FAT32_EOF                  	0x0FFFFFFF
 
+//The amount of FAT sectors that are kept in RAM (512 bytes each). Sectors are
+//written back to the card (into every copy of the FAT) when they are pushed out
+//of the cache or when FAT32_Cache_Flush() is called.
+#define FAT_CACHE_SIZE              3
+#define FAT_CACHE_EMPTY             0xFFFFFFFF
+
+//The FSInfo sector keeps the free cluster count and where to start looking for
+//a free cluster. 0xFFFFFFFF means the value is not known.
+#define FSINFO_LEAD_SIG             0x41615252
+#define FSINFO_STRUCT_SIG           0x61417272
+#define FSINFO_UNKNOWN              0xFFFFFFFF
+
 /*************************************************
 *                   Macros                       *
 *************************************************/
@@ -60,7 +72,10 @@ void FAT32_File_Properties(SD_FILE *FILE1);
 void FAT32_Display_Data(UINT8 *buf, UINT16 len, UINT8 format);
 
 UINT8 FAT32_Init(void); 
-UINT8 FAT32_Read_File(SD_FILE *FILE1);
+UINT8 FAT32_Cache_Flush(void);
+UINT8 FAT32_Cache_Write(UINT8 slot);
+UINT8 FAT32_Cache_Read(UINT32 sector, UINT8 *slot);
+UINT8 FAT32_Read_File(SD_FILE *FILE1, UINT8 *buf, UINT16 buf_size);
 UINT8 FAT32_Write_FAT(UINT32 cluster, UINT32 data);
 UINT8 FAT32_Open_File(char file_name[13], SD_FILE *FILE1); 
 UINT8 FAT32_Write_File(char filename[13],UINT32 filesize);
@@ -70,5 +85,6 @@ UINT16 FAT32_Get_Offset(UINT32 filesize, UINT16 buf_size);
 UINT32 FAT32_Next_Free_Cluster(void);
 UINT32 FAT32_Total_Free_Clusters(void);
 UINT32 FAT32_Next_Cluster(UINT32 cluster);
+UINT32 FAT32_Last_Cluster(UINT32 cluster);
 
 #endif
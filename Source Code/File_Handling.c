@@ -59,7 +59,7 @@ void Run_SD_Animation(char filename[16])
   
   memset(SD_buf,0x00,4096);
   
-  SD_Read_Mul_Sectors(FILE1.start_sector,8);
+  SD_Read_Mul_Sectors(FILE1.start_sector,8,SD_buf);
   
   printf("\r\n\r\n");
   FAT32_Display_Data(SD_buf,4096,1);
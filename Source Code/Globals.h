@@ -89,7 +89,13 @@ seq[22] - Scrolling_Arrows()
 seq[23] - Intro_Animation()
 seq[24] - Our_Test_Animation()
 seq[25] - Cycle_Pod_Animations_Sense()
-seq[26] -
+seq[26] - Game_Of_Life()
+seq[27] - Falling_Sand()
+seq[28] - Rain()
+seq[29] - Grid_Ripple()
+seq[30] - Ring_Ripple()
+seq[31] - Pod_Sweep()
+seq[32] -
 .
 .
 .
@@ -98,6 +104,12 @@ seq[49] -
 
 UINT32 IR_sensors = 0;
 UINT32 count32 = 0;
+
+//The animation clock. Advances with the tempo of the music (see Anim_Check())
+UINT32 anim_count = 0;
+UINT16 anim_rate = 256;
+UINT16 anim_period = 0;
+UINT8 anim_beat = 0;
 UINT32 NEC_code;
 UINT32 grid_row[12] = {0,0,0,0,0,0,0,0,0,0,0,0};
 UINT32 grid_frame[12] = {0,0,0,0,0,0,0,0,0,0,0,0};
@@ -154,9 +166,9 @@ UINT8 VU_Meter = 0x00;
 9  - BW2_JAM          (LED_Graphics.h)
 10 - SCROLL_FINISHED  (LED_Graphics.h)
 11 - MODE_STANDBY     (LED_Control.h)
-12 - 
-13 - 
-14 - 
+12 - ADC_BACKGROUND   (ADC_Setup.h)
+13 - IR_LOCK_IN       (IR_Sensors.h)
+14 - VU_AUTO          (VU_Control.h)
 15 -
 ***************************************/
 
@@ -191,7 +203,10 @@ RGB COLOR[11] = {
 RGB CUSTOM_COLOR1 = {65535,25000,0};
 RGB CUSTOM_COLOR2 = {0,0,65535};    
 
-UINT16 VU_signal[7] = {0,0,0,0,0,0,0};         
+UINT16 VU_signal[7] = {0,0,0,0,0,0,0};
+
+//The VU levels after VU_Update(), which the VU animations draw
+UINT16 VU_display[7] = {0,0,0,0,0,0,0};         
                       
 const char UART_CMD[25][32] = {"BT",								//0
                                "BT+MENU",						//1
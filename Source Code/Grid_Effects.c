@@ -0,0 +1,556 @@
+/*******************************************************************************
+* Title: Grid_Effects.c
+* Version: 1.0
+* Author: robotros
+* Date: October 19, 2026
+*
+* Description:
+* This file contains the LED grid effects engine. Game of Life, falling sand and
+* rain are cellular automatons that are computed with bitwise operations on
+* whole grid rows, so that each frame only costs a few hundred word operations.
+* The ripple is drawn from the grid distances in the table map.
+* The particle system draws short lived particles (such as the explosions that
+* are shown when a cup is removed) into the effects layer of the grid.
+*******************************************************************************/
+
+#ifndef GRID_EFFECTS_C
+#define GRID_EFFECTS_C
+
+#include "Main_Includes.h"
+#include "Delay_Setup.h"
+#include "Grid_Setup.h"
+#include "Grid_Effects.h"
+#include "Table_Map.h"
+
+/*************************************************
+*               Global Variables                 *
+*************************************************/
+extern volatile T16_FLAG FLAG1;
+
+extern volatile UINT32 count32;
+extern volatile UINT32 anim_count;
+extern volatile UINT32 grid_row[12];
+extern volatile UINT8 seq[SEQ_AMOUNT];
+
+extern const MAP_POINT pod_map[22];
+extern const UINT8 map_max_distance[MAP_CENTERS];
+
+//Particles with a 'life' of 0 are free to be used by the next explosion
+PARTICLE particle[PARTICLE_MAX];
+
+//The direction of each explosion particle. 16 directions around a circle,
+//scaled to one pixel per frame in 8.8 fixed point.
+const INT16 particle_dir_x[16] = { 256, 237, 181,  98,    0,  -98, -181, -237,
+                                  -256,-237,-181, -98,    0,   98,  181,  237};
+const INT16 particle_dir_y[16] = {   0,  98, 181, 237,  256,  237,  181,   98,
+                                     0, -98,-181,-237, -256, -237, -181,  -98};
+
+/*************************************************
+*                   Macros                       *
+*************************************************/
+//Rotate a grid row one column, wrapping the pixel that falls off the edge
+#define ROW_ROTATE_RIGHT(x)   (((x) << 1) | ((x) >> 31))
+#define ROW_ROTATE_LEFT(x)    (((x) >> 1) | ((x) << 31))
+
+/*******************************************************************************
+* Function: Effect_Random(void)
+*
+* Variables:
+* N/A
+*
+* Description:
+* This function returns a 32-bit pseudo random value (xorshift). A full row of
+* random pixels can be made with one call, and ANDing several calls together
+* halves the amount of set pixels each time.
+*******************************************************************************/
+UINT32 Effect_Random(void)
+{
+  static UINT32 state = 0;
+
+  //Seed the generator from the system timer the first time it is used
+  if (state == 0)
+  {
+    state = count32 ^ 0x2545F491;
+
+    if (state == 0)
+      state = 0x2545F491;
+  }
+
+  state ^= state << 13;
+  state ^= state >> 17;
+  state ^= state << 5;
+
+  return state;
+}
+
+/*******************************************************************************
+* Function: Game_Of_Life(void)
+*
+* Variables:
+* N/A
+*
+* Description:
+* This function runs Conway's Game of Life on the LED grid. The edges of the
+* grid wrap around. The 8 neighbours of every pixel in a row are counted at the
+* same time with bit-sliced adders, each bit of a counter word holds one bit of
+* the count for the matching column. If the grid dies out or stops changing, it
+* is reseeded with random pixels. This animation will loop forever.
+*******************************************************************************/
+UINT8 Game_Of_Life(void)
+{
+  UINT8 i, up, down;
+  UINT32 h0[GRID_Y_MAX], h1[GRID_Y_MAX];
+  UINT32 left, right, centre, m0, m1, s0, s1, s2, t0, t1, t2, t3, carry;
+  UINT32 sum;
+  static UINT32 tmark = 0;
+  static UINT32 history[2];
+  static UINT8 stale = 0;
+
+  //Set variables to start up state if seq[x] is in reset state
+  if (seq[26] == 0xFF)
+  {
+    seq[26] = 0;
+    tmark = anim_count;
+    stale = LIFE_STALE_LIMIT;
+  }
+
+  //Only calculate a new generation once every few frames
+  if (!Anim_Check(&tmark,EFFECT_FRAME_TIME*4))
+    return 1;
+
+  //If the grid is empty or has been stuck in a loop for too long, reseed it
+  if (stale >= LIFE_STALE_LIMIT)
+  {
+    for (i = 0;i < GRID_Y_MAX;i++)
+      grid_row[i] = Effect_Random() & (Effect_Random() | Effect_Random());
+
+    stale = 0;
+    history[0] = 0;
+    history[1] = 0;
+  }
+
+  //Count each pixel in a row and its left and right neighbours. h0 and h1 hold
+  //the 2-bit result (0 to 3) for every column of the row.
+  for (i = 0;i < GRID_Y_MAX;i++)
+  {
+    centre = grid_row[i];
+    left = ROW_ROTATE_LEFT(centre);
+    right = ROW_ROTATE_RIGHT(centre);
+
+    h0[i] = left ^ centre ^ right;
+    h1[i] = (left & centre) | (right & (left ^ centre));
+  }
+
+  sum = 0;
+
+  for (i = 0;i < GRID_Y_MAX;i++)
+  {
+    up = (i == 0) ? (GRID_Y_MAX - 1) : (i - 1);
+    down = (i == (GRID_Y_MAX - 1)) ? 0 : (i + 1);
+
+    //The neighbours in the same row do not include the pixel itself
+    centre = grid_row[i];
+    left = ROW_ROTATE_LEFT(centre);
+    right = ROW_ROTATE_RIGHT(centre);
+    m0 = left ^ right;
+    m1 = left & right;
+
+    //Add the row above to the same row neighbours (result is 0 to 5)
+    s0 = h0[up] ^ m0;
+    carry = h0[up] & m0;
+    s1 = h1[up] ^ m1 ^ carry;
+    s2 = (h1[up] & m1) | (carry & (h1[up] ^ m1));
+
+    //Add the row below (result is 0 to 8)
+    t0 = s0 ^ h0[down];
+    carry = s0 & h0[down];
+    t1 = s1 ^ h1[down] ^ carry;
+    carry = (s1 & h1[down]) | (carry & (s1 ^ h1[down]));
+    t2 = s2 ^ carry;
+    t3 = s2 & carry;
+
+    //A pixel is on in the next generation if it has 3 neighbours, or if it
+    //is already on and has 2 neighbours. The rows above and below have
+    //already been counted in h0/h1 so the row can be replaced right away.
+    grid_row[i] = t1 & ~t2 & ~t3 & (t0 | centre);
+
+    //Keep a checksum of the generation to find still and blinking patterns
+    sum = ROW_ROTATE_RIGHT(sum) ^ grid_row[i];
+  }
+
+  //If the generation matches one of the last two, the grid has stopped changing
+  if (sum == 0 || sum == history[0] || sum == history[1])
+    stale++;
+  else
+    stale = 0;
+
+  //The grid is empty, reseed it on the next generation
+  if (sum == 0)
+    stale = LIFE_STALE_LIMIT;
+
+  history[1] = history[0];
+  history[0] = sum;
+
+  UPDATE_FRAME();
+
+  return 1;
+}
+
+/*******************************************************************************
+* Function: Falling_Sand(void)
+*
+* Variables:
+* N/A
+*
+* Description:
+* This function pours sand from a wandering spout at the top of the LED grid.
+* Every grain falls if the pixel below it is empty, otherwise it slides down to
+* the left or right. The slide direction that is checked first alternates each
+* frame so that the pile stays even. All of the grains in a row are moved at the
+* same time. Once the pile reaches the spout, the sand drains out of the bottom
+* of the grid and the animation starts over. This animation will loop forever.
+*******************************************************************************/
+UINT8 Falling_Sand(void)
+{
+  UINT8 i, y;
+  UINT32 fall, slide;
+  static UINT32 tmark = 0;
+  static UINT8 spout = 16;
+  static UINT8 direction = 0;
+
+  //Set variables to start up state if seq[x] is in reset state
+  if (seq[27] == 0xFF)
+  {
+    seq[27] = 0;
+    tmark = anim_count;
+    spout = GRID_X_MAX / 2;
+
+    for (i = 0;i < GRID_Y_MAX;i++)
+      grid_row[i] = 0;
+  }
+
+  //Wait until the next frame
+  if (!Anim_Check(&tmark,EFFECT_FRAME_TIME))
+    return 1;
+
+  //The pile is full, drain one row out of the bottom of the grid each frame
+  if (seq[27] > 0)
+  {
+    for (i = GRID_Y_MAX - 1;i > 0;i--)
+      grid_row[i] = grid_row[i-1];
+
+    grid_row[0] = 0;
+
+    if (++seq[27] > (GRID_Y_MAX + 1))
+      seq[27] = 0;
+  }
+
+  else
+  {
+    //Move the grains, starting at the bottom so that a grain can only fall
+    //one row per frame
+    for (y = GRID_Y_MAX - 1;y-- > 0;)
+    {
+      //Grains with an empty pixel below them fall straight down
+      fall = grid_row[y] & ~grid_row[y+1];
+      grid_row[y+1] |= fall;
+      grid_row[y] &= ~fall;
+
+      //Grains slide down diagonally if the pixel beside them and the pixel
+      //below that are both empty
+      if (direction)
+      {
+        slide = grid_row[y] & (~grid_row[y+1] << 1) & (~grid_row[y] << 1);
+        grid_row[y+1] |= slide >> 1;
+        grid_row[y] &= ~slide;
+
+        slide = grid_row[y] & (~grid_row[y+1] >> 1) & (~grid_row[y] >> 1);
+        grid_row[y+1] |= slide << 1;
+        grid_row[y] &= ~slide;
+      }
+
+      else
+      {
+        slide = grid_row[y] & (~grid_row[y+1] >> 1) & (~grid_row[y] >> 1);
+        grid_row[y+1] |= slide << 1;
+        grid_row[y] &= ~slide;
+
+        slide = grid_row[y] & (~grid_row[y+1] << 1) & (~grid_row[y] << 1);
+        grid_row[y+1] |= slide >> 1;
+        grid_row[y] &= ~slide;
+      }
+    }
+
+    direction ^= 1;
+
+    //Let the spout wander left and right
+    switch (Effect_Random() & 0x0F)
+    {
+      case 0:  if (spout > 2) spout--;                break;
+      case 1:  if (spout < (GRID_X_MAX - 3)) spout++; break;
+    }
+
+    //If the spout is blocked the pile is full, start draining the grid.
+    //Otherwise pour a new grain.
+    if ((grid_row[0] >> spout) & 0x00000001)
+      seq[27] = 1;
+    else
+      grid_row[0] |= ((UINT32) 1) << spout;
+  }
+
+  UPDATE_FRAME();
+
+  return 1;
+}
+
+/*******************************************************************************
+* Function: Rain(UINT8 density)
+*
+* Variables:
+* density -> The amount of drops. Each step up halves the amount of new drops
+*            (0 is the heaviest rain)
+*
+* Description:
+* This function makes it rain on the LED grid. Every frame all of the rows move
+* down one row and a new row of random drops is added to the top. This animation
+* will loop forever.
+*******************************************************************************/
+UINT8 Rain(UINT8 density)
+{
+  UINT8 i;
+  UINT32 drops;
+  static UINT32 tmark = 0;
+
+  //Set variables to start up state if seq[x] is in reset state
+  if (seq[28] == 0xFF)
+  {
+    seq[28] = 0;
+    tmark = anim_count;
+  }
+
+  //Wait until the next frame
+  if (!Anim_Check(&tmark,EFFECT_FRAME_TIME*2))
+    return 1;
+
+  //Move the rain down one row
+  for (i = GRID_Y_MAX - 1;i > 0;i--)
+    grid_row[i] = grid_row[i-1];
+
+  //Make a new row of drops, each AND removes about half of them
+  drops = Effect_Random() & Effect_Random();
+
+  for (i = 0;i < density;i++)
+    drops &= Effect_Random();
+
+  //Don't start a drop directly above another one so that the drops stay short
+  grid_row[0] = drops & ~grid_row[1];
+
+  UPDATE_FRAME();
+
+  return 1;
+}
+
+/*******************************************************************************
+* Function: Grid_Ripple(UINT8 center)
+*
+* Variables:
+* center -> The center that the ripples move out from (MAP_xxx)
+*
+* Description:
+* This function draws rings of pixels on the LED grid that move out from
+* 'center', like ripples on water. A new ring starts every RIPPLE_SPACING half
+* pixels. The rings are drawn with the distances in the table map (see
+* Table_Map.c), so no circle math is done. This animation will loop forever.
+*******************************************************************************/
+UINT8 Grid_Ripple(UINT8 center)
+{
+  UINT8 i;
+  UINT8 r;
+  static UINT32 tmark = 0;
+
+  //Set variables to start up state if seq[x] is in reset state
+  if (seq[29] == 0xFF)
+  {
+    seq[29] = 0;
+    tmark = anim_count;
+  }
+
+  //Wait until the next frame
+  if (!Anim_Check(&tmark,EFFECT_FRAME_TIME*4))
+    return 1;
+
+  for (i = 0;i < GRID_Y_MAX;i++)
+    grid_row[i] = 0;
+
+  //Draw every ring, the first one is 'seq[29]' half pixels from the center
+  for (r = seq[29];r <= map_max_distance[center];r += RIPPLE_SPACING)
+    Map_Draw_Band(center,r,r + RIPPLE_WIDTH);
+
+  //Move the rings out, once the first ring reaches RIPPLE_SPACING a new one
+  //starts at the center
+  seq[29] = (seq[29] + 1) % RIPPLE_SPACING;
+
+  UPDATE_FRAME();
+
+  return 1;
+}
+
+/*******************************************************************************
+* Function: Particle_Explosion(UINT8 px, UINT8 py, UINT8 amount)
+*
+* Variables:
+* px -> The column that the explosion starts at (0-31)
+* py -> The row that the explosion starts at (0-11)
+* amount -> The amount of particles to create
+*
+* Description:
+* This function creates 'amount' particles at (px,py) that fly out in random
+* directions. If there are not enough free particles, the explosion will use
+* as many as are available. The particles are moved and drawn by
+* Update_Particles().
+*******************************************************************************/
+void Particle_Explosion(UINT8 px, UINT8 py, UINT8 amount)
+{
+  UINT8 i;
+  UINT8 direction;
+  INT16 speed;
+  UINT32 random;
+
+  for (i = 0;(i < PARTICLE_MAX) && amount;i++)
+  {
+    //This particle is still in use
+    if (particle[i].life)
+      continue;
+
+    random = Effect_Random();
+    direction = random & 0x0F;
+
+    //Give each particle a speed between 0.5 and 1 pixel per frame
+    speed = (PARTICLE_ONE / 2) + ((random >> 4) & 0x7F);
+
+    //Start in the middle of the pixel
+    particle[i].x = (((INT16) px) << 8) + (PARTICLE_ONE / 2);
+    particle[i].y = (((INT16) py) << 8) + (PARTICLE_ONE / 2);
+    particle[i].vx = (INT16) (((INT32) particle_dir_x[direction] * speed) >> 8);
+    particle[i].vy = (INT16) (((INT32) particle_dir_y[direction] * speed) >> 8);
+    particle[i].life = PARTICLE_LIFE - ((random >> 12) & 0x0F);
+
+    amount--;
+  }
+}
+
+/*******************************************************************************
+* Function: Pod_Explosion(UINT8 pod)
+*
+* Variables:
+* pod -> The pod that the explosion is for (1-20)
+*
+* Description:
+* This function starts an explosion on the LED grid at the pixel that is the 
+* closest to 'pod' on the table (see Table_Map.c).
+*******************************************************************************/
+void Pod_Explosion(UINT8 pod)
+{
+  UINT8 px, py;
+
+  if (pod < 1 || pod > 20)
+    return;
+
+  Map_To_Grid(pod_map[pod],&px,&py);
+  Particle_Explosion(px,py,PARTICLE_BURST);
+}
+
+/*******************************************************************************
+* Function: Update_Particles(void)
+*
+* Variables:
+* N/A
+*
+* Description:
+* This function moves every particle that is alive, applies gravity and draws
+* them into the effects layer of the LED grid. Particles that leave the grid or
+* run out of life are freed. This must be called continuously while particles
+* are in use. Returns the amount of particles that are still alive.
+*******************************************************************************/
+UINT8 Update_Particles(void)
+{
+  UINT8 i;
+  UINT8 alive = 0;
+  UINT32 *rows;
+  static UINT32 tmark = 0;
+  static UINT8 drawn = 0;
+
+  //Wait until the next frame
+  if (!Time_Check(&tmark,EFFECT_FRAME_TIME))
+    return drawn;
+
+  rows = Layer_Rows(LAYER_EFFECTS);
+
+  //Nothing was drawn last frame and there is nothing to draw now
+  if (drawn == 0)
+  {
+    for (i = 0;i < PARTICLE_MAX;i++)
+    {
+      if (particle[i].life)
+        break;
+    }
+
+    if (i == PARTICLE_MAX)
+      return 0;
+  }
+
+  for (i = 0;i < GRID_Y_MAX;i++)
+    rows[i] = 0;
+
+  for (i = 0;i < PARTICLE_MAX;i++)
+  {
+    if (particle[i].life == 0)
+      continue;
+
+    particle[i].x += particle[i].vx;
+    particle[i].y += particle[i].vy;
+    particle[i].vy += PARTICLE_GRAVITY;
+    particle[i].life--;
+
+    //Free the particle if it has left the sides or bottom of the grid.
+    //Particles above the grid can still fall back onto it.
+    if (particle[i].x < 0 || particle[i].x >= (GRID_X_MAX << 8) ||
+        particle[i].y >= (GRID_Y_MAX << 8))
+      particle[i].life = 0;
+
+    if (particle[i].life == 0)
+      continue;
+
+    alive++;
+
+    if (particle[i].y >= 0)
+      rows[particle[i].y >> 8] |= ((UINT32) 1) << (particle[i].x >> 8);
+  }
+
+  //Write the new particle positions to the grid
+  Layer_Update(LAYER_EFFECTS);
+  drawn = alive;
+
+  return alive;
+}
+
+/*******************************************************************************
+* Function: Clear_Particles(void)
+*
+* Variables:
+* N/A
+*
+* Description:
+* This function frees every particle and clears the effects layer of the grid.
+*******************************************************************************/
+void Clear_Particles(void)
+{
+  UINT8 i;
+
+  for (i = 0;i < PARTICLE_MAX;i++)
+    particle[i].life = 0;
+
+  Layer_Clear(LAYER_EFFECTS);
+}
+
+#endif
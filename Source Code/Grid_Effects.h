@@ -0,0 +1,72 @@
+/*******************************************************************************
+* Title: Grid_Effects.h
+* Version: 1.0
+* Author: robotros
+* Date: October 19, 2026
+*
+* Description:
+* This file contains the function prototypes and definitions for the LED grid
+* effects engine. The cellular automaton effects work on whole grid rows at a
+* time (one UINT32 per row) instead of looping through each pixel.
+*******************************************************************************/
+
+#ifndef GRID_EFFECTS_H
+#define GRID_EFFECTS_H
+
+/*************************************************
+*                   Constants                    *
+*************************************************/
+//The time between frames of an effect in ms (~60 frames per second)
+#define EFFECT_FRAME_TIME     16
+
+//The distance between the rings of Grid_Ripple() and the width of each ring,
+//in half grid pixels
+#define RIPPLE_SPACING        10
+#define RIPPLE_WIDTH          2
+
+//The maximum amount of particles that can be alive at the same time
+#define PARTICLE_MAX          32
+
+//The amount of particles that are created when a cup is removed
+#define PARTICLE_BURST        16
+
+//Particle positions and velocities are 8.8 fixed point values
+#define PARTICLE_ONE          256
+
+//Added to the vertical velocity of each particle every frame
+#define PARTICLE_GRAVITY      12
+
+//The amount of frames that a particle stays alive
+#define PARTICLE_LIFE         40
+
+//The amount of generations before Game_Of_Life() reseeds a stale grid
+#define LIFE_STALE_LIMIT      30
+
+//The amount of frames that Falling_Sand() lets the pile sit once it is full
+#define SAND_FULL_FRAMES      60
+
+//Stores the state of one particle. 'x' and 'y' are pixel positions and 'vx'
+//and 'vy' are the pixels moved per frame, all in 8.8 fixed point.
+typedef struct
+{
+  INT16 x;
+  INT16 y;
+  INT16 vx;
+  INT16 vy;
+  UINT8 life;
+} PARTICLE;
+
+/*************************************************
+*              Function Prototypes               *
+*************************************************/
+UINT32 Effect_Random(void);
+UINT8 Game_Of_Life(void);
+UINT8 Falling_Sand(void);
+UINT8 Rain(UINT8 density);
+UINT8 Grid_Ripple(UINT8 center);
+void Particle_Explosion(UINT8 px, UINT8 py, UINT8 amount);
+void Pod_Explosion(UINT8 pod);
+UINT8 Update_Particles(void);
+void Clear_Particles(void);
+
+#endif
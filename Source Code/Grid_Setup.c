@@ -27,6 +27,20 @@ extern volatile T16_FLAG FLAG1;
 extern volatile UINT32 grid_row[12];
 extern volatile UINT32 grid_frame[12];
 
+//The upper layers of the grid (LAYER_BASE is grid_row[12] and is not stored here)
+volatile GRID_LAYER grid_layer[GRID_LAYERS - 1];
+
+//Set when the matching upper layer has new data that needs to be composited. One
+//byte per layer, so that setting a flag from the main loop can never lose a flag
+//that an interrupt (Update_Text()) sets at the same time.
+volatile UINT8 layer_dirty[GRID_LAYERS - 1];
+
+//The retained scene that currently owns the base layer (SCENE_NONE if none)
+volatile UINT8 active_scene = SCENE_NONE;
+
+//Increments at the start of each refresh cycle of the grid (see Grid_VSync())
+volatile UINT16 grid_vsync = 0;
+
 /*******************************************************************************
 * Function: Grid_Init(void)                                                                   * 
 *                                                                            
@@ -77,11 +91,10 @@ void Grid_Frame_Update(UINT32 *data)
 * This function controls the refreshing of the LED grid. Seeing as the LED grid
 * is being multiplexed, this function will cycle through each LED grid row
 * continuously and update the frame data in the process. The refresh rate of
-* the LED grid is determined by Timer5.                                                                             
+* the LED grid is determined by Timer5 (the INT1 interrupt that it sets off).                                                                             
 *******************************************************************************/
 void Grid_Control(void)
 {   
-  UINT8 i;
   UINT8 buf[6];
   static UINT8 row = 0;
   
@@ -124,19 +137,231 @@ void Grid_Control(void)
   {
 	  //Prepare to begin the cycle again
     row = 0;   
+    grid_vsync++;
+    
+    //If there is new data on any layer, composite the layers into the frame data 
+    //at the start of the frame to prevent tearing on the screen
+    if (GRID_UPDATE || layer_dirty[LAYER_EFFECTS-1] || layer_dirty[LAYER_TEXT-1])
+      Grid_Composite();
+  }
+}
+
+/*******************************************************************************
+* Function: Grid_VSync(UINT16 *mark)                                                                   
+*                                                                             
+* Variables:                                                                  
+* *mark -> The last refresh cycle this caller has drawn (start at 0)
+*                                                                             
+* Description:                                                                
+* This function returns a 1 once per refresh cycle of the grid (every GRID_Y_MAX
+* ms), otherwise a 0. Animations that only draw when it returns a 1 draw once for
+* each frame that is shown, however fast the main loop is running.
+*******************************************************************************/
+UINT8 Grid_VSync(UINT16 *mark)
+{
+  if (*mark == grid_vsync)
+    return 0;
+  
+  *mark = grid_vsync;
+  
+  return 1;
+}
+
+/*******************************************************************************
+* Function: Grid_Composite(void)                                                                   
+*                                                                             
+* Variables:                                                                  
+* N/A                                                                         
+*                                                                             
+* Description:                                                                
+* This function combines the base layer (grid_row) with each enabled upper layer
+* and writes the result into the grid's frame data. It is called by Grid_Control()
+* once per refresh cycle, and only when a layer has been marked as updated. Each
+* layer is combined one row at a time with its blend operation:
+*
+* LAYER_BLEND_OR       -> The layer's pixels are added on top of the lower layers
+* LAYER_BLEND_XOR      -> The layer's pixels invert the pixels of the lower layers
+* LAYER_BLEND_MASK     -> The layer's pixels are cut out of the lower layers                                                                            
+*******************************************************************************/
+void Grid_Composite(void)
+{
+  UINT8 i,j;
+  UINT32 value;
+  
+  for (i = 0;i < GRID_Y_MAX;i++)
+  {
+	  //Start with the base layer that all of the animations draw into
+    value = grid_row[i];
     
-    //If there is new data to be sent to the grid, do it at the start of the frame
-    //to prevent tearing on the screen
-    if (GRID_UPDATE)
+    //Combine each enabled layer, from the bottom of the stack to the top
+    for (j = 0;j < (GRID_LAYERS - 1);j++)
     {
-	    //Update the frame data
-      for (i = 0;i < GRID_Y_MAX;i++)
-        grid_frame[i] = grid_row[i];
+      if (!grid_layer[j].enabled)
+        continue;
+        
+      switch (grid_layer[j].blend)
+      {
+        case LAYER_BLEND_OR:       value |= grid_layer[j].row[i];   break;
+        case LAYER_BLEND_XOR:      value ^= grid_layer[j].row[i];   break;
+        case LAYER_BLEND_MASK:     value &= ~grid_layer[j].row[i];  break;
+      }
+    }
       
-      //Reset the flag  
-      GRID_UPDATE = 0;
-    }    
+    grid_frame[i] = value;
   }
+  
+  //All of the layers are now up to date
+  GRID_UPDATE = 0;
+  
+  for (i = 0;i < (GRID_LAYERS - 1);i++)
+    layer_dirty[i] = 0;
+}
+
+/*******************************************************************************
+* Function: Layer_Init(void)                                                                   
+*                                                                             
+* Variables:                                                                  
+* N/A                                                                         
+*                                                                             
+* Description:                                                                
+* This function clears all of the upper layers of the LED grid and sets them to
+* their default blend operations. The effects and text layers are both added on
+* top of the base layer.                                                                             
+*******************************************************************************/
+void Layer_Init(void)
+{
+  UINT8 i;
+  
+  //Clear all of the upper layers and enable them
+  for (i = 1;i < GRID_LAYERS;i++)
+  {
+    Layer_Clear(i);
+    Layer_Enable(i,ON);
+  }  
+  
+  //Set the default blend operation of each layer
+  Layer_Set_Blend(LAYER_EFFECTS,LAYER_BLEND_OR);
+  Layer_Set_Blend(LAYER_TEXT,LAYER_BLEND_OR);
+}
+
+/*******************************************************************************
+* Function: Layer_Rows(UINT8 layer)                                                                   
+*                                                                             
+* Variables:                                                                  
+* layer -> The layer whose pixel data is returned                                                                        
+*                                                                             
+* Description:                                                                
+* This function returns a pointer to the 12 rows of pixel data of a layer, so
+* that drawing routines can write into any layer. LAYER_BASE returns grid_row.                                                                             
+*******************************************************************************/
+UINT32 *Layer_Rows(UINT8 layer)
+{
+  //The base layer and any invalid layers point to the regular grid data
+  if (layer == LAYER_BASE || layer >= GRID_LAYERS)
+    return (UINT32 *)grid_row;
+    
+  return (UINT32 *)grid_layer[layer-1].row;
+}
+
+/*******************************************************************************
+* Function: Layer_Update(UINT8 layer)                                                                   
+*                                                                             
+* Variables:                                                                  
+* layer -> The layer that has been modified                                                                        
+*                                                                             
+* Description:                                                                
+* This function marks a layer as modified so that it will be composited into the
+* LED grid at the start of the next refresh cycle. For LAYER_BASE this is the
+* same as calling UPDATE_FRAME().                                                                            
+*******************************************************************************/
+void Layer_Update(UINT8 layer)
+{
+  if (layer == LAYER_BASE)
+    UPDATE_FRAME();
+    
+  else if (layer < GRID_LAYERS)
+    layer_dirty[layer-1] = 1;
+}
+
+/*******************************************************************************
+* Function: Layer_Clear(UINT8 layer)                                                                   
+*                                                                             
+* Variables:                                                                  
+* layer -> The layer that will be cleared                                                                        
+*                                                                             
+* Description:                                                                
+* This function will clear all of the pixels of a layer. In order to write the
+* cleared layer to the LED grid, call Layer_Update(layer) after this function.                                                                             
+*******************************************************************************/
+void Layer_Clear(UINT8 layer)
+{
+  UINT8 i;
+  UINT32 *rows;
+  
+  rows = Layer_Rows(layer);
+  
+  for (i = 0;i < GRID_Y_MAX;i++)
+    rows[i] = 0x00000000;
+}
+
+/*******************************************************************************
+* Function: Layer_Set_Blend(UINT8 layer, UINT8 blend)                                                                   
+*                                                                             
+* Variables:                                                                  
+* layer -> The layer that will be modified
+* blend -> The blend operation (LAYER_BLEND_OR, XOR or MASK)                                                                        
+*                                                                             
+* Description:                                                                
+* This function sets how a layer is combined with the layers below it.                                                                            
+*******************************************************************************/
+void Layer_Set_Blend(UINT8 layer, UINT8 blend)
+{
+  if (layer == LAYER_BASE || layer >= GRID_LAYERS)
+    return;
+    
+  grid_layer[layer-1].blend = blend;
+  Layer_Update(layer);
+}
+
+/*******************************************************************************
+* Function: Layer_Enable(UINT8 layer, UINT8 state)                                                                   
+*                                                                             
+* Variables:                                                                  
+* layer -> The layer that will be modified
+* state -> Shows the layer (ON) or hides it (OFF)                                                                        
+*                                                                             
+* Description:                                                                
+* This function shows or hides one of the upper layers without clearing it.                                                                            
+*******************************************************************************/
+void Layer_Enable(UINT8 layer, UINT8 state)
+{
+  if (layer == LAYER_BASE || layer >= GRID_LAYERS)
+    return;
+    
+  grid_layer[layer-1].enabled = state;
+  Layer_Update(layer);
+}
+
+/*******************************************************************************
+* Function: Layer_Shift_Left(UINT8 layer, UINT8 amount)                                                                   
+*                                                                             
+* Variables:                                                                  
+* layer -> The layer that will be shifted
+* amount -> The amount of columns that the layer will be shifted over                                                                        
+*                                                                             
+* Description:                                                                
+* This function works the same as Shift_Grid_Left(a) but shifts any layer. To
+* display the shifted layer, call Layer_Update(layer) after this function.                                                                          
+*******************************************************************************/
+void Layer_Shift_Left(UINT8 layer, UINT8 amount)
+{
+  UINT8 i;
+  UINT32 *rows;
+  
+  rows = Layer_Rows(layer);
+  
+  for (i = 0;i < GRID_Y_MAX;i++)
+    rows[i] >>= amount;
 }
 
 /*******************************************************************************
@@ -154,6 +379,9 @@ void Shift_Grid_Right(UINT8 amount)
 {  
   UINT8 i;
   
+  //The base layer is being redrawn, any retained scene is no longer displayed
+  Scene_Invalidate();
+  
   //Shift the data on the grid x amount of times to the right
   for (i = 0;i < GRID_Y_MAX;i++)
     grid_row[i] <<= amount;              
@@ -174,9 +402,106 @@ void Shift_Grid_Left(UINT8 amount)
 {  
   UINT8 i;
   
+  //The base layer is being redrawn, any retained scene is no longer displayed
+  Scene_Invalidate();
+  
   //Shift the data on the grid x amount of times to the left
   for (i = 0;i < GRID_Y_MAX;i++)
     grid_row[i] >>= amount;              
 }
+
+/*******************************************************************************
+* Function: Scene_Needs_Render(GRID_SCENE *scene, UINT32 input)                                                                   
+*                                                                             
+* Variables:                                                                  
+* *scene -> The retained scene that is being checked
+* input -> All of the values that the scene is drawn from, packed into 32-bits                                                                        
+*                                                                             
+* Description:                                                                
+* This function lets a static screen (such as the scoreboard) skip redrawing the
+* LED grid when nothing has changed. It returns a 1 if the scene has to be drawn
+* again and a 0 if the grid already shows it. A scene has to be drawn again when
+* its inputs have changed, when another animation has drawn into the base layer
+* since the scene was last rendered or while a transition is running. After 
+* drawing the scene, call Scene_Rendered(scene).                                                                            
+*******************************************************************************/
+UINT8 Scene_Needs_Render(GRID_SCENE *scene, UINT32 input)
+{
+  //A transition is running, render each frame until it finishes
+  if (scene->transition)
+  {
+    scene->transition--;
+    scene->input = input;
+    return 1;
+  }
+  
+  //The scene is no longer on the grid or has never been drawn
+  if (active_scene != scene->id || !scene->valid)
+  {
+    scene->input = input;
+    return 1;
+  }
+  
+  //One of the inputs that the scene is drawn from has changed
+  if (input != scene->input)
+  {
+    scene->input = input;
+    return 1;
+  }
+  
+  //The grid already displays the scene
+  return 0;
+}
+
+/*******************************************************************************
+* Function: Scene_Rendered(GRID_SCENE *scene)                                                                   
+*                                                                             
+* Variables:                                                                  
+* *scene -> The retained scene that has just been drawn                                                                        
+*                                                                             
+* Description:                                                                
+* This function records that a retained scene has been drawn into the base layer.
+* It must be called after the scene is drawn and after its UPDATE_FRAME(), as
+* drawing routines such as Clear_Grid() and UPDATE_FRAME() itself invalidate the
+* active scene.                                                                            
+*******************************************************************************/
+void Scene_Rendered(GRID_SCENE *scene)
+{
+  scene->valid = 1;
+  active_scene = scene->id;
+}
+
+/*******************************************************************************
+* Function: Scene_Transition(GRID_SCENE *scene, UINT16 frames)                                                                   
+*                                                                             
+* Variables:                                                                  
+* *scene -> The retained scene that is starting a transition
+* frames -> The amount of renders that the transition lasts                                                                        
+*                                                                             
+* Description:                                                                
+* This function forces a retained scene to be rendered for the next 'frames'
+* calls of Scene_Needs_Render(a,b), even if its inputs do not change.                                                                            
+*******************************************************************************/
+void Scene_Transition(GRID_SCENE *scene, UINT16 frames)
+{
+  scene->transition = frames;
+}
+
+/*******************************************************************************
+* Function: Scene_Invalidate(void)                                                                   
+*                                                                             
+* Variables:                                                                  
+* N/A                                                                         
+*                                                                             
+* Description:                                                                
+* This function is called whenever the base layer is drawn over by something
+* other than a retained scene. UPDATE_FRAME() calls it, so any animation, the
+* Bluetooth grid upload or the VU meter that writes grid_row directly is covered.
+* The next retained scene that is shown will then render itself in full again.                                                                            
+*******************************************************************************/
+void Scene_Invalidate(void)
+{
+  active_scene = SCENE_NONE;
+}
   
 #endif
@@ -24,18 +24,75 @@
 #define GRID_X_MAX            32
 #define GRID_Y_MAX            12
 
+//The amount of layers that are composited into each frame. Layer 0 is always
+//grid_row[12] so that all of the existing animations draw into the base layer.
+#define GRID_LAYERS           3
+
+//Layer designations, from the bottom of the stack to the top
+#define LAYER_BASE            0
+#define LAYER_EFFECTS         1
+#define LAYER_TEXT            2
+
+//Blend operations used to combine a layer with the layers below it
+#define LAYER_BLEND_OR        0
+#define LAYER_BLEND_XOR       1
+#define LAYER_BLEND_MASK      2
+
+//Retained scene IDs. SCENE_NONE means that the base layer was last drawn by
+//a regular animation and any retained scene has to render itself again.
+#define SCENE_NONE            0
+#define SCENE_SCOREBOARD      1
+
+//Stores the pixel data for one of the upper layers of the LED grid
+typedef struct
+{
+  UINT32 row[GRID_Y_MAX];
+  UINT8  blend;
+  UINT8  enabled;
+} GRID_LAYER;
+
+//Stores the state of a retained scene. A retained scene is only rendered again
+//when its inputs change, when another producer has drawn over it or while a
+//transition is running.
+typedef struct
+{
+  UINT8  id;
+  UINT8  valid;
+  UINT16 transition;
+  UINT32 input;
+} GRID_SCENE;
+
 /*************************************************
 *                   Macros                       *
 *************************************************/
-#define UPDATE_FRAME()      (GRID_UPDATE = 1)
+//Writing a new frame of the base layer means that any retained scene is no
+//longer shown, so the scene has to render itself again (see Scene_Rendered())
+#define UPDATE_FRAME()      (Scene_Invalidate(), GRID_UPDATE = 1)
 
 /*************************************************
 *              Function Prototypes               *
 *************************************************/
 void Grid_Init(void);
 void Grid_Control(void);
+UINT8 Grid_VSync(UINT16 *mark);
 void Shift_Grid_Left(UINT8 amount);
 void Shift_Grid_Right(UINT8 amount);
 void Grid_Frame_Update(UINT32 *data);
 
+void Layer_Init(void);
+void Grid_Composite(void);
+void Layer_Clear(UINT8 layer);
+void Layer_Update(UINT8 layer);
+void Layer_Enable(UINT8 layer, UINT8 state);
+void Layer_Set_Blend(UINT8 layer, UINT8 blend);
+void Layer_Shift_Left(UINT8 layer, UINT8 amount);
+
+UINT32 *Layer_Rows(UINT8 layer);
+
+void Scene_Invalidate(void);
+void Scene_Rendered(GRID_SCENE *scene);
+void Scene_Transition(GRID_SCENE *scene, UINT16 frames);
+
+UINT8 Scene_Needs_Render(GRID_SCENE *scene, UINT32 input);
+
 #endif
@@ -20,6 +20,24 @@
 * To save time, the ADC module is set up to sample four inputs (AN0 - AN3)
 * simultaneously. AN3 is used for the VU meter module and does not affect the operation
 * of the IR sensors, although it does get read with them. 
+*
+* The sensors are read in the background. Timer3 triggers the ADC and every 250us
+* (ADC_OVERSAMPLE conversions averaged together) the ADC interrupt (IR_Acquire()) 
+* stores the readings and moves the 74HC4051's 
+* on to the next input, which gives them a full period to settle. All 24 sensors are
+* read every 2ms. Each full scan is written into one half of a ping-pong buffer and
+* then published, while the next scan fills the other half. The sensors are 
+* debounced as each scan is published (IR_Debounce()), which also queues an
+* event for each change, and the main loop only copies the last published scan 
+* (IR_Snapshot()) to update the thresholds.
+*
+* In lock-in mode (IR_Lock_In()) the IR transmitters are switched on for one
+* Timer1 frame and off for IR_GATE_OFF_FRAMES frames (IR_Gate()). The scans taken
+* while they are off measure the light from the pods and the room, which is then
+* subtracted from the scans taken while they are on. Only the difference (the IR
+* light reflected back from a cup) is published. The switch is only passed on
+* to the ADC interrupt once the TLC5955 has latched it (IR_Gate_Latched()), and
+* any scan that was interrupted by the transmitters switching is thrown away.
 *                                                                    
 * The IR sensor values will be stored in a 24-byte variable array as follows:
 *
@@ -72,6 +90,7 @@
 #include "LED_Control.h"
 #include "Delay_Setup.h"
 #include "TLC5955_Setup.h"
+#include "EEPROM_Setup.h"
 #include <stdio.h>
 
 /*************************************************
@@ -84,90 +103,290 @@ extern volatile UINT16 IR_value[24];
 extern volatile UINT16 TLC_data[96];
 
 extern volatile UINT32 sensor_bits;
+extern volatile UINT32 count32;
 
 extern volatile RGB COLOR[11];
 
+extern volatile UINT16 adc_sample[4];
+
+extern volatile T16_FLAG FLAG1;
+extern volatile UINT16 TLC_data2[96];
+
+//Ping-pong buffer of IR sensor scans. The ADC interrupt fills one half while
+//the other half holds the last complete scan (IR_scan[IR_scan_ready]).
+volatile UINT16 IR_scan[2][IR_SENSORS];
+volatile UINT8 IR_scan_ready = 0;
+
+//Increments each time a complete scan is published
+volatile UINT16 IR_scan_count = 0;
+
+//Lock-in detection. IR_gate_on is set while the IR transmitters are on and
+//IR_gate_count increments every time they are switched. IR_gate_next is the
+//state that IR_Gate() has written to the TLC5955, which only becomes IR_gate_on
+//once it has been latched (see IR_Gate_Latched()).
+volatile UINT8 IR_gate_on = 1;
+volatile UINT8 IR_gate_next = 1;
+volatile UINT8 IR_gate_count = 0;
+
+//The last readings taken while the IR transmitters were off. IR_dark_valid is
+//set once a full dark scan has been taken since lock-in mode was turned on.
+volatile UINT16 IR_dark[IR_SENSORS];
+volatile UINT8 IR_dark_valid = 0;
+
+//The reading that each sensor has to rise above to detect a cup ([0]), and to
+//stay above to keep detecting it ([1]). Set by Update_All_Sensors() and used by
+//IR_Debounce() in the ADC interrupt, which keeps the debounced state in IR_state.
+//IR_reported is the state that is reported (sensors with a fault never detect).
+volatile UINT16 IR_trip[2][IR_SENSORS];
+volatile UINT32 IR_state = 0;
+volatile UINT32 IR_reported = 0;
+
+//Ring buffer of sensor change events. IR_Debounce() (ADC interrupt) is the only
+//writer; each reader keeps its own cursor (see IR_Event_Read()). IR_event_head
+//counts every event that has been written.
+volatile IR_EVENT IR_event[IR_EVENT_SIZE];
+volatile UINT16 IR_event_head = 0;
+
+//Adaptive baseline (IR_BASE_FRAC fraction bits) and noise variance (IR_NOISE_FRAC
+//fraction bits) of each sensor, see Update_All_Sensors()
+UINT32 IR_baseline[IR_SENSORS];
+UINT32 IR_noise[IR_SENSORS];
+
+//Sensor health (see IR_Health_Update()). The statistics of the window that is
+//being gathered (health_detect has a bit set for each sensor that detected
+//something during it), and the faults that were found in the last complete window.
+//IR_health has a bit set for each sensor with a fault.
+UINT16 health_min[IR_SENSORS];
+UINT16 health_max[IR_SENSORS];
+UINT8 health_flips[IR_SENSORS];
+UINT16 health_count = 0;
+UINT32 health_detect = 0;
+
+UINT8 IR_fault[IR_SENSORS];
+volatile UINT32 IR_health = 0;
+
+//Background calibration (see Sensor_Calibration()). cal_samples counts the scans
+//that have been added up so far and equals CAL_DIV when no calibration is running.
+UINT8 cal_samples = CAL_DIV;
+UINT32 cal_sum[IR_SENSORS];
+UINT32 cal_sum_sq[IR_SENSORS];
+
 /*******************************************************************************
 * Function: Sensor_Calibration(void)                                                                    
 *                                                                              
 * Variables:                                                                   
-* IR_cal[24] -> All calibration analog values stored in this global UINT16 array                                                                          
+* N/A
 *                                                                              
 * Description:                                                                 
-* This function will calibrate the IR sensors by reading each sensor 'n' amount of                                                                            
-* times and calculating the average reading. The amount of times that each sensor                                                                             
-* be read is determined by CAL_DIV located in the header file. Since average is a
-* 16-bit variable, CAL_DIV should not go above the value of 64.
-* 
-* Max ADC Value = 1023
-*                  
-* average = 1023 * CAL_DIV_MAX (64)
-*         = 65472
-*                  
-* If CAL_DIV is any higher than 64 and your ADC values are at max value for all of 
-* the readings, you will overflow the 16-bit 'average' variable. If you need more
-* than 64 readings to average, you can change 'average' to a 32-bit varaiable.                                                                            
+* This function starts calibrating the IR sensors in the background and returns
+* right away. The next CAL_DIV scans that Update_All_Sensors() reads are added up
+* by IR_Calibrate() (about 2 seconds) and the animations keep running the whole
+* time. The progress can be checked with IR_Calibration_Status().
 *******************************************************************************/
 void Sensor_Calibration(void)
 {
-  UINT8 i,j,k;
-  UINT8 tracker;
-    
-  UINT16 adc_value[4];
+  UINT8 i;
   
   //Turn on the IR transmitters 
-  Set_IR_PWM(65535); 
-  ADC_CHANNEL(3);
+  Set_IR_PWM(TX_MAX_BRIGHTNESS); 
   
-  //Turn on all pods to their max brightness before calibration
-  Set_All_Pods(COLOR[WHITE]);
-  Delay_ms(50);
-  
-  //Reset each calibrated value to 0
-  for (i = 0;i < 24;i++)
-    cal_light[i] = 0; 
-  
-  //Begin reading each sensors value multiple times
-  for (k = 0;k < CAL_DIV;k++)
-  { 
-	  //There are 3x 75HC4051 ICs, each with 8 inputs. Read each input. 
-    for (j = 0;j < 8;j++)
-    {  
-	    //Read analog inputs AN0 - AN3  
-      ADC_Read_SS(adc_value);  
-      Delay_us(10); 
-      
-      //Update the 74HC4051's to read the next input
-      IR_CHANNEL(j+1);
+  //Reset the sums of each sensor
+  for (i = 0;i < IR_SENSORS;i++)
+  {
+    cal_sum[i] = 0;
+    cal_sum_sq[i] = 0;
+  }   
+  
+  cal_samples = 0;
+}	
+
+/*******************************************************************************
+* Function: IR_Calibrate(UINT16 *values, UINT32 detected)                                                                    
+*                                                                              
+* Variables:                                                                   
+* *values -> The latest scan of the IR sensors
+* detected -> The sensors that are currently detecting something
+*                                                                              
+* Description:                                                                 
+* This function is called by Update_All_Sensors() with every scan. While a 
+* calibration is running, it adds up each reading (and its square) of each sensor.
+* After CAL_DIV scans, the average seeds the adaptive baseline of each sensor and
+* the variance seeds its noise estimate. Sensors that are detecting a cup keep
+* the baseline they had. Returns a 1 while the calibration is still running.
+* 
+* Max ADC Value = 2046 (ADC_SAMPLE_MAX)
+*                  
+* cal_sum_sq = 2046^2 * CAL_DIV_MAX (250) = 1046529000
+*
+* Shifting that left by IR_NOISE_FRAC would overflow, so the average of the 
+* squares is worked out from the quotient and remainder separately.
+*******************************************************************************/
+UINT8 IR_Calibrate(UINT16 *values, UINT32 detected)
+{
+  UINT8 i;
+  UINT32 mean;
+  
+  if (cal_samples >= CAL_DIV)
+    return 0;
+  
+  //Keeping adding up each read (and its square) which will allow us to find
+  //the average and the variance of the readings
+  for (i = 0;i < IR_SENSORS;i++)
+  {
+    cal_sum[i] += values[i];
+    cal_sum_sq[i] += (UINT32) values[i] * values[i];
+  }
+  
+  if (++cal_samples < CAL_DIV)
+    return 1;
+  
+  for (i = 0;i < IR_SENSORS;i++)
+  {
+    if (detected & ((UINT32)1 << i))
+      continue;
       
-      //Seperate each analog reading into its respective place in the sensor array
-      for (i = 0;i < 3;i++)
-      { 
-	      //Calculate which sensor the analog reading corresponds to 
-        tracker = j + (i*8);
-        
-        //Keeping adding up each read which will allow us to average the readings
-        cal_light[tracker] += adc_value[i];
-      }    
-    } 
+    //Average of the readings with IR_NOISE_FRAC fraction bits
+    mean = (cal_sum[i] << IR_NOISE_FRAC) / CAL_DIV;
+    
+    //Variance = average of the squares - square of the average
+    IR_noise[i] = ((cal_sum_sq[i] / CAL_DIV) << IR_NOISE_FRAC) + (((cal_sum_sq[i] % CAL_DIV) << IR_NOISE_FRAC) / CAL_DIV) -
+                  ((mean * mean) >> IR_NOISE_FRAC);
     
-    //Allow a couple of milliseconds between each read to settle the inputs
-    //This really isn't neccessary and is just here to ensure solid readings
-    Delay_ms(2);
+    IR_baseline[i] = mean << (IR_BASE_FRAC - IR_NOISE_FRAC);
+    cal_light[i] = cal_sum[i] / CAL_DIV;
   }  
   
-  //Average the readings of each sensor   
-  for (i = 0;i < 24;i++)
-    cal_light[i] /= CAL_DIV;
+  //Keep the calibration so that it doesn't have to be done at every power up
+  IR_Save_Calibration();
   
-  //Send the calibrated readings out the UART module, this is nice for debugging
-  for (i = 0;i < 24;i++)   
-      printf("Light [%u]: %u\r\n",i,cal_light[i]);
-  
-  //Turn off the pods after calibration
-  Set_All_Pods(COLOR[BLACK]);
+  return 0;
+}
+
+/*******************************************************************************
+* Function: IR_Calibration_Status(void)                                                                    
+*                                                                              
+* Variables:                                                                   
+* N/A
+*                                                                              
+* Description:                                                                 
+* Returns how far along the background calibration is, from 0 to 100 (%). A 100
+* means that no calibration is running.
+*******************************************************************************/
+UINT8 IR_Calibration_Status(void)
+{
+  return ((UINT16) cal_samples * 100) / CAL_DIV;
 }	
 
+/*******************************************************************************
+* Function: IR_Save_Calibration(void)                                                                    
+*                                                                              
+* Variables:                                                                   
+* N/A
+*                                                                              
+* Description:                                                                 
+* This function saves the baseline and noise estimate of each sensor in the 
+* EEPROM, along with the record version, the lock-in mode and a CRC. Returns
+* EEPROM_SUCCESS (0) or the error from EEPROM_Write().
+*******************************************************************************/
+UINT8 IR_Save_Calibration(void)
+{
+  UINT8 i,error;
+  IR_CAL_RECORD record;
+  
+  record.version = IR_CAL_VERSION;
+  record.lock_in = IR_LOCK_IN;
+  
+  for (i = 0;i < IR_SENSORS;i++)
+  {
+    record.baseline[i] = IR_baseline[i];
+    record.noise[i] = IR_noise[i];
+  }  
+  
+  record.crc = EEPROM_CRC((UINT8 *) &record,sizeof(record) - sizeof(record.crc));
+  
+  //Disable the TMR1 interrupt so that the SPI2 bus does not get interrupted by 
+  //an RGB pod update (TLC5955) during an EEPROM operation
+  _T1IE = 0;
+  
+  //Wait for any write that is still in progress
+  while ((EEPROM_Status() & 0x03) != 0);
+  
+  error = EEPROM_Write(IR_CAL_EE_ADDR,(UINT8 *) &record,sizeof(record));
+  
+  _T1IE = 1;
+  
+  return error;
+}
+
+/*******************************************************************************
+* Function: IR_Load_Calibration(void)                                                                    
+*                                                                              
+* Variables:                                                                   
+* N/A
+*                                                                              
+* Description:                                                                 
+* This function reads the saved calibration out of the EEPROM in one burst. If
+* the record is valid (version, lock-in mode and CRC match), it is checked against
+* a fresh scan of the sensors. A cup can be sitting on any pod at power up so pods
+* may read above their baseline, but no sensor should read far below it and the
+* ball washer sensors should read close to it. If anything doesn't match, nothing
+* is loaded and the sensors need a full calibration.
+*
+* Returns: IR_CAL_SUCCESS -> The calibration was loaded
+*          IR_CAL_INVALID -> There is no valid record in the EEPROM
+*          IR_CAL_MISMATCH -> The record doesn't match the sensor readings
+*******************************************************************************/
+UINT8 IR_Load_Calibration(void)
+{
+  UINT8 i;
+  UINT16 count;
+  INT16 delta;
+  
+  UINT16 values[IR_SENSORS];
+  IR_CAL_RECORD record;
+  
+  //Disable TMR1 so that it won't interrupt the SPI2 bus
+  _T1IE = 0;
+  
+  EEPROM_Read(IR_CAL_EE_ADDR,(UINT8 *) &record,sizeof(record));
+  
+  _T1IE = 1;
+  
+  if ((record.version != IR_CAL_VERSION) || (record.lock_in != IR_LOCK_IN) ||
+      (record.crc != EEPROM_CRC((UINT8 *) &record,sizeof(record) - sizeof(record.crc))))
+    return IR_CAL_INVALID;
+  
+  //Wait for two new scans so that the one that is read was started after now
+  for (i = 0;i < 2;i++)
+  {
+    count = IR_scan_count;
+    
+    while (count == IR_scan_count);
+  }
+  
+  IR_Snapshot(values);
+  
+  for (i = 0;i < IR_SENSORS;i++)
+  {
+    delta = (INT16) values[i] - (INT16) (record.baseline[i] >> IR_BASE_FRAC);
+    
+    if (delta < -IR_MAX_DELTA)
+      return IR_CAL_MISMATCH;
+      
+    if ((((UINT32)1 << i) & BW_SENSOR_MASK) && (delta > IR_MAX_DELTA))
+      return IR_CAL_MISMATCH;
+  }    
+  
+  for (i = 0;i < IR_SENSORS;i++)
+  {
+    IR_baseline[i] = record.baseline[i];
+    IR_noise[i] = record.noise[i];
+    cal_light[i] = IR_baseline[i] >> IR_BASE_FRAC;
+  }
+  
+  return IR_CAL_SUCCESS;
+}
+
 /*******************************************************************************
 * Function: Update_Sensors(void)                                                                  
 *                                                                              
@@ -176,8 +395,11 @@ void Sensor_Calibration(void)
 *                                                                              
 * Description:                                                                 
 * This function will update the value of the IR sensors which can then be compared
-* to the calibrated values to see if a detection has been made (cup moved, ball
-* put in washer, etc.). This function will return a 32-bit integer where each
+* to the baseline of each sensor to see if a detection has been made (cup moved, ball
+* put in washer, etc.). While nothing is over a sensor its baseline and noise
+* estimate keep following its readings, so slow changes in the room lighting or
+* the IR transmitters don't build up into false (or missed) detections over a
+* long session. This function will return a 32-bit integer where each
 * bit represents one of the IR sensors. The format is as follow:
 *
 *   Bit#  |  Sensor
@@ -213,71 +435,628 @@ void Sensor_Calibration(void)
 *******************************************************************************/
 UINT32 Update_All_Sensors(void)
 { 
-  UINT8 i,j;
-  UINT8 tracker;
+  UINT8 i;
+  INT16 delta;
+  UINT16 base,threshold;
   
-  INT16 adc_value[4];
+  UINT16 values[IR_SENSORS];
   
-  UINT32 data = 0;
-  static UINT32 last_data[5] = {0,0,0,0,0};
+  UINT32 bit;
+  UINT32 detected,changed;
   
-  //Prepare to start simultaneously reading channels AN0 - AN3
-  ADC_CHANNEL(3);
+  //The debounced state of each sensor the last time this function was called
+  static UINT32 state = 0;
+  
+  //Get the last complete scan of the sensors, which is read in the background
+  IR_Snapshot(values);
+  
+  //While the sensors are being calibrated, hold the thresholds
+  if (IR_Calibrate(values,state))
+    return IR_Reported();
+  
+  //The sensors are debounced with every scan in the ADC interrupt
+  detected = IR_Debounced();
+  
+  for (i = 0;i < IR_SENSORS;i++)
+  {   
+    bit = (UINT32)1 << i;
+    
+    //Store each sensors most current light reading in a global array
+    //This allows us to retrieve these values when testing the sensors in the PC app
+    IR_value[i] = values[i];
+    
+    delta = (INT16) values[i] - (INT16) (IR_baseline[i] >> IR_BASE_FRAC);
+    
+    //Only learn from the sensor while there is nothing over it
+    if (((detected & bit) == 0) && (values[i] <= IR_trip[0][i]))
+    {
+      //Keep a hand or ball passing overhead from blowing up the noise estimate
+      if (delta < -IR_MAX_DELTA)
+        delta = -IR_MAX_DELTA;
+        
+      IR_baseline[i] += (INT32) (((UINT32) values[i] << IR_BASE_FRAC) - IR_baseline[i]) >> IR_BASE_SHIFT;
+      IR_noise[i] += (INT32) (((UINT32) ((INT32) delta * delta) << IR_NOISE_FRAC) - IR_noise[i]) >> IR_NOISE_SHIFT;
+      
+      cal_light[i] = IR_baseline[i] >> IR_BASE_FRAC;
+    }  
+    
+    //A cup is detected once the reading rises above the baseline by more than
+    //the threshold. A sensor that is already detecting only has to stay above
+    //a fraction of it. This keeps readings that sit near the threshold from
+    //flickering on and off.
+    base = IR_baseline[i] >> IR_BASE_FRAC;
+    threshold = IR_Threshold(i);
+    
+    IR_trip[0][i] = base + threshold;
+    IR_trip[1][i] = base + (threshold >> IR_HOLD_SHIFT);
+  } 
+  
+  //The sensors that changed state since the last call
+  changed = detected ^ state;
+  state = detected;
+  
+  //Keep track of the health of each sensor. Sensors with a fault are ignored
+  //from the next scan on (IR_Debounce() queues their events).
+  IR_Health_Update(values,state,changed);
+  
+  //Return the sensor data
+  return IR_Reported(); 
+}
+  
+
+/*******************************************************************************
+* Function: IR_Health_Update(UINT16 *values, UINT32 detected, UINT32 changed)
+*
+* Variables:
+* *values -> The latest scan of the IR sensors
+* detected -> The debounced state of the sensors
+* changed -> The sensors whose debounced state just changed
+*
+* Description:
+* This function is called by Update_All_Sensors() with every scan. It keeps the
+* lowest and highest reading and the amount of state changes of each sensor, 
+* which only takes a couple of compares per sensor. At the end of each window of
+* IR_HEALTH_WINDOW scans, each sensor is checked for faults (IR_fault[]) and the
+* statistics start over. A cup sitting on a pod holds its reading steady (or 
+* at the top of the scale), so sensors that detected something during the window
+* are not checked for being stuck or saturated. Returns IR_health, the sensors 
+* that have a fault.
+*******************************************************************************/
+UINT32 IR_Health_Update(UINT16 *values, UINT32 detected, UINT32 changed)
+{
+  UINT8 i,fault;
+  
+  if (health_count == 0)
+    health_detect = 0;
+    
+  health_detect |= detected;
   
-  //Prepare to sample all of the input channels on each 74HC4051
-  for (j = 0;j < 8;j++)
-  {    	    
-	  //Read analog inputs AN0 - AN3  
-    ADC_Read_SS(adc_value);  
+  for (i = 0;i < IR_SENSORS;i++)
+  {
+    if (health_count == 0)
+    {
+      health_min[i] = values[i];
+      health_max[i] = values[i];
+      health_flips[i] = 0;
+    }
+      
+    if (values[i] < health_min[i])
+      health_min[i] = values[i];
       
-    //Update the 74HC4051's to read the next input
-    IR_CHANNEL(j+1);
+    if (values[i] > health_max[i])
+      health_max[i] = values[i];
+      
+    if ((changed & ((UINT32)1 << i)) && (health_flips[i] < 0xFF))
+      health_flips[i]++;  
+  }
+  
+  if (++health_count < IR_HEALTH_WINDOW)
+    return IR_health;
+  
+  //The window is complete, check each sensor
+  health_count = 0;
+  IR_health = 0;
+  
+  for (i = 0;i < IR_SENSORS;i++)
+  {
+    fault = 0;
     
-	  //There are 3x 75HC4051 ICs, each with 8 inputs. Read each input. 
-    for (i = 0;i < 3;i++)
-    {   
-	    //Calculate which sensor the analog reading corresponds to 
-      tracker = j + (i*8);
+    if ((health_detect & ((UINT32)1 << i)) == 0)
+    {
+      if ((health_max[i] - health_min[i]) <= IR_STUCK_RANGE)
+        fault |= IR_FAULT_STUCK;
+        
+      if (health_min[i] >= IR_SATURATED)
+        fault |= IR_FAULT_SATURATED;
+    }
       
-      //Store each sensors most current light reading in a global array
-      //This allows us to retrieve these values when testing the sensors in the PC app
-      IR_value[tracker] = adc_value[i];
+    if (IR_noise[i] > ((UINT32) IR_NOISE_LIMIT * IR_NOISE_LIMIT << IR_NOISE_FRAC))
+      fault |= IR_FAULT_NOISY;
       
-      //If the received ADC value is much larger than the calibrated value,
-      //an object has been detected. Set the bit to 1.
-      if ((adc_value[i] - cal_light[tracker]) > 110)      
-        data |= ((UINT32)1 << tracker); 
+    if (health_flips[i] > IR_FLIP_LIMIT)
+      fault |= IR_FAULT_FLIPPING;
+    
+    IR_fault[i] = fault;
+    
+    if (fault)
+      IR_health |= ((UINT32)1 << i);
+  }
+  
+  return IR_health;
+}
+
+/*******************************************************************************
+* Function: IR_Threshold(UINT8 sensor)
+*
+* Variables:
+* sensor -> The IR sensor (0 - 23)
+*
+* Description:
+* Returns the rise above the baseline (in ADC counts) that the sensor currently
+* needs to see before it detects a cup. This is IR_NOISE_GAIN standard deviations
+* of the sensors noise, limited to IR_MIN_DELTA and IR_MAX_DELTA.
+*******************************************************************************/
+UINT16 IR_Threshold(UINT8 sensor)
+{
+  UINT32 var = ((UINT32) IR_NOISE_GAIN * IR_NOISE_GAIN * IR_noise[sensor]) >> IR_NOISE_FRAC;
+  UINT16 root = 0;
+  UINT16 bit = 0x8000;
+  
+  //Bit by bit integer square root
+  while (bit)
+  {
+    if (((UINT32) (root | bit) * (root | bit)) <= var)
+      root |= bit;
       
-      //No object has been detected, clear the bit to a 0  
-      else
-        data &= ~((UINT32)1 << tracker);  
-    }    
-  } 
+    bit >>= 1;
+  }  
   
-  //This is a really basic form of error checking. It is needed for heavily
-  //frosted acrylic sheets where lots of the IR light is reflected back into
-  //the receiver. Set the IR sensitivty low enough that it never false detects
-  //a cup when there isn't one over top of the pod. This way, when you do set a
-  //cup over top of the pod, it may have the odd false detection where it may not
-  //'see' the cup on top of it but the last 4 readings will tell it otherwise.
-  //Unless it has 5 false detections in a row (which I haven't had happen), it
-  //won't change the detection rate of the sensor. This is a very basic way of error
-  //checking, but it seems to work great. If you are using a clear acrylic sheet, you
-  //can take it out and won't need it. Anything frosted, it's a good idea to keep it.
-  last_data[4] = last_data[3];
-  last_data[3] = last_data[2];
-  last_data[2] = last_data[1];
-  last_data[1] = last_data[0];
-  last_data[0] = data;
-  
-  //OR all of the last 5 readings together. If there is a false detection in the
-  //bunch where it thinks no cup is above the sensor and it is, the other 4
-  //readings will adjust it.
-  data = last_data[0] | last_data[1] | last_data[2] | last_data[3] | last_data[4];
+  if (root < IR_MIN_DELTA)
+    return IR_MIN_DELTA;
   
-  //Return the sensor data
-  return data; 
-}  
+  if (root > IR_MAX_DELTA)
+    return IR_MAX_DELTA;
+    
+  return root;
+}
+
+/*******************************************************************************
+* Function: IR_Start_Acquisition(void)                                                                    
+*                                                                              
+* Variables:                                                                   
+* N/A                                                                          
+*                                                                              
+* Description:                                                                 
+* This function starts reading the IR sensors in the background. The ADC is 
+* triggered by Timer3 and each conversion is handled by IR_Acquire() in the ADC
+* interrupt. The first complete scan is ready 2ms after this is called.
+*******************************************************************************/
+void IR_Start_Acquisition(void)
+{
+  UINT8 i;
+  
+  //Nothing can be detected until Update_All_Sensors() sets the thresholds
+  for (i = 0;i < IR_SENSORS;i++)
+  {
+    IR_trip[0][i] = 0xFFFF;
+    IR_trip[1][i] = 0xFFFF;
+  }  
+  
+  //Start on the first input of each 74HC4051
+  IR_CHANNEL(0);
+  
+  ADC_CHANNEL(3);
+  ADC_Start_Triggered();
+}
+
+/*******************************************************************************
+* Function: IR_Acquire(void)                                                                    
+*                                                                              
+* Variables:                                                                   
+* N/A                                                                          
+*                                                                              
+* Description:                                                                 
+* This function is called from the ADC interrupt after ADC_Store_Sample(). It 
+* stores the three IR readings (one from each 74HC4051) in the half of the 
+* ping-pong buffer that is being filled and selects the next multiplexer input.
+* Once all 8 inputs have been read, the scan is published and the other half of
+* the buffer is filled next. In lock-in mode, the readings taken while the IR 
+* transmitters are off are stored in IR_dark[] instead and only the scans taken
+* while they are on are published.
+*******************************************************************************/
+void IR_Acquire(void)
+{
+  static UINT8 channel = 0;
+  static UINT8 fill = 1;
+  static UINT8 gate = 0;
+  
+  UINT8 i;
+  UINT16 dark;
+  volatile UINT16 *scan;
+  
+  //The IR transmitters were switched during this scan, these readings were taken
+  //while the sensors were settling. Start the scan over from the first input.
+  if (gate != IR_gate_count)
+  {
+    gate = IR_gate_count;
+    channel = 0;
+    IR_CHANNEL(0);
+    return;
+  }
+  
+  //Readings taken with the transmitters off go in the dark scan
+  if (IR_LOCK_IN && (IR_gate_on == 0))
+    scan = IR_dark;
+  else
+    scan = IR_scan[fill];
+  
+  //AN0 - AN2 are the three 74HC4051's, each with 8 sensors
+  scan[channel] = adc_sample[0];
+  scan[channel + 8] = adc_sample[1];
+  scan[channel + 16] = adc_sample[2];
+  
+  //Subtract the light that is there without the IR transmitters
+  if (IR_LOCK_IN && IR_gate_on)
+  {
+    for (i = channel;i < IR_SENSORS;i += 8)
+    {
+      dark = IR_dark[i];
+      scan[i] = (scan[i] > dark) ? (scan[i] - dark) : 0;
+    }  
+  }  
+  
+  //Select the next input, it has until the next conversion to settle
+  channel++;
+  IR_CHANNEL(channel);
+  
+  //All of the sensors have been read, publish the scan and start on the other
+  //half of the buffer
+  if (channel > 7)
+  {
+    channel = 0;
+    
+    if (scan == IR_dark)
+    {
+      IR_dark_valid = 1;
+      return;
+    }
+    
+    //Don't publish a difference until there is a dark scan to subtract
+    if (IR_LOCK_IN && !IR_dark_valid)
+      return;
+    
+    IR_Debounce(scan);
+      
+    IR_scan_ready = fill;
+    fill ^= 1;
+    IR_scan_count++;
+  }  
+}
+
+/*******************************************************************************
+* Function: IR_Debounce(volatile UINT16 *scan)                                                                    
+*                                                                              
+* Variables:                                                                   
+* *scan -> The scan that is about to be published
+*                                                                              
+* Description:                                                                 
+* This function is called from the ADC interrupt by IR_Acquire() with every scan
+* that is published, so the sensors are debounced at the scan rate instead of 
+* the ~20ms that Update_All_Sensors() runs at. Each sensor is compared to the
+* thresholds in IR_trip[] and all of them are debounced at once. This is needed
+* for heavily frosted acrylic sheets where lots of the IR light is reflected back
+* into the receiver and a cup may have the odd reading where it isn't 'seen', or
+* an empty pod the odd reading where it is. A sensor only changes state once it
+* has disagreed with its current state for IR_PRESS_COUNT (cup placed) or 
+* IR_RELEASE_COUNT (cup removed) scans in a row (IR_LOCK_PRESS_COUNT and
+* IR_LOCK_RELEASE_COUNT in lock-in mode). An event is queued for each sensor 
+* whose reported state changed as soon as it is confirmed.
+*******************************************************************************/
+void IR_Debounce(volatile UINT16 *scan)
+{
+  UINT8 i,slot;
+  
+  UINT32 bit = 1;
+  UINT32 data = 0;
+  UINT32 state = IR_state;
+  UINT32 change,carry,next,match;
+  UINT32 press,release;
+  UINT32 reported;
+  
+  //A vertical counter (one bit of the count of each sensor per word) of the 
+  //scans in a row that disagreed with the state of each sensor
+  static UINT32 count[3] = {0,0,0};
+  
+  for (i = 0;i < IR_SENSORS;i++,bit <<= 1)
+  {
+    if (scan[i] > IR_trip[(state & bit) ? 1 : 0][i])
+      data |= bit;
+  }
+  
+  change = data ^ state;
+  
+  //Sensors that agree with their state start counting again from 0
+  count[0] &= change;
+  count[1] &= change;
+  count[2] &= change;
+  
+  //Add 1 to the count of the sensors that disagree
+  carry = change;
+  next = count[0] & carry; count[0] ^= carry; carry = next;
+  next = count[1] & carry; count[1] ^= carry; carry = next;
+  count[2] ^= carry;
+  
+  //Sensors that have reached their confirm count
+  if (IR_LOCK_IN)
+  {
+    press = VC_EQUAL(count,IR_LOCK_PRESS_COUNT);
+    release = VC_EQUAL(count,IR_LOCK_RELEASE_COUNT);
+  }
+  else
+  {
+    press = VC_EQUAL(count,IR_PRESS_COUNT);
+    release = VC_EQUAL(count,IR_RELEASE_COUNT);
+  }
+  
+  match = (~state & ~BW_SENSOR_MASK & press) |
+          (~state & BW_SENSOR_MASK & VC_EQUAL(count,BW_PRESS_COUNT)) |
+          (state & release);
+  match &= change;
+  
+  //Change their state and clear their counts
+  state ^= match;
+  IR_state = state;
+  
+  count[0] &= ~match;
+  count[1] &= ~match;
+  count[2] &= ~match;
+  
+  //The sensors whose reported state changed. This also covers a sensor that was
+  //just masked off (IR_health) while detecting, or unmasked while detecting.
+  reported = state & ~IR_health;
+  match = reported ^ IR_reported;
+  IR_reported = reported;
+  
+  //Queue an event for every sensor that changed. The event is written before
+  //the head moves so that a reader never sees a half written event.
+  for (i = 0;match;i++,match >>= 1)
+  {
+    if (match & 0x01)
+    {
+      slot = IR_event_head & (IR_EVENT_SIZE - 1);
+      
+      IR_event[slot].time = count32;
+      IR_event[slot].sensor = i;
+      IR_event[slot].state = (reported >> i) & 0x01;
+      
+      IR_event_head++;
+    }  
+  }  
+}
+
+/*******************************************************************************
+* Function: IR_Debounced(void)                                                                    
+*                                                                              
+* Variables:                                                                   
+* N/A                                                                          
+*                                                                              
+* Description:                                                                 
+* Returns the debounced state of the IR sensors (IR_state). If a new scan is 
+* published while it is read, it is read again so that both halves of it always
+* come from the same scan.
+*******************************************************************************/
+UINT32 IR_Debounced(void)
+{
+  UINT16 count;
+  UINT32 state;
+  
+  do
+  {
+    count = IR_scan_count;
+    state = IR_state;
+  
+  } while (count != IR_scan_count);
+  
+  return state;
+}
+
+/*******************************************************************************
+* Function: IR_Reported(void)                                                                    
+*                                                                              
+* Variables:                                                                   
+* N/A                                                                          
+*                                                                              
+* Description:                                                                 
+* Returns the reported state of the IR sensors (IR_reported), the debounced
+* state without the sensors that have a fault. This is the state that the events
+* follow. It is read the same way as IR_Debounced().
+*******************************************************************************/
+UINT32 IR_Reported(void)
+{
+  UINT16 count;
+  UINT32 state;
+  
+  do
+  {
+    count = IR_scan_count;
+    state = IR_reported;
+  
+  } while (count != IR_scan_count);
+  
+  return state;
+}
+
+/*******************************************************************************
+* Function: IR_Lock_In(UINT8 state)                                                                    
+*                                                                              
+* Variables:                                                                   
+* state -> ON: Gate the IR transmitters and subtract the ambient light
+*          OFF: Leave the IR transmitters on all of the time
+*                                                                              
+* Description:                                                                 
+* This function turns lock-in detection on or off. With it on, the readings no
+* longer depend on the color of the pods or the light in the room, and the IR
+* transmitters are only on for 1 out of every (IR_GATE_OFF_FRAMES + 1) frames.
+* Since the readings change scale, the sensors should be calibrated again after
+* changing the mode.
+*******************************************************************************/
+void IR_Lock_In(UINT8 state)
+{
+  //Restart the scan. The transmitters are (or will be, once latched) on, and 
+  //lock-in mode publishes nothing until a dark scan has been taken
+  IR_dark_valid = 0;
+  IR_gate_next = 1;
+  IR_gate_count++;
+  
+  IR_LOCK_IN = state;
+  
+  //Leave the IR transmitters on at their set brightness 
+  if (state == OFF)
+    TLC5955_Update();
+}
+
+/*******************************************************************************
+* Function: IR_Gate(void)                                                                    
+*                                                                              
+* Variables:                                                                   
+* N/A                                                                          
+*                                                                              
+* Description:                                                                 
+* This function is called from the Timer1 interrupt before the TLC5955 channels
+* are written. In lock-in mode it switches the IR transmitters on for one frame
+* and then off for IR_GATE_OFF_FRAMES frames. The IR transmitter channel is 
+* written every frame, so the value in TLC_data2[] is overwritten here even if
+* TLC5955_Update() copied IR_duty into it, but the TLC5955 is only written 
+* (~1ms) on the frames where the transmitters switch.
+*******************************************************************************/
+void IR_Gate(void)
+{
+  static UINT8 frame = 0;
+  
+  if (IR_LOCK_IN == 0)
+    return;
+  
+  if (IR_gate_on)
+  {
+    IR_gate_next = 0;
+    frame = 0;
+  }
+  else if (++frame >= IR_GATE_OFF_FRAMES)
+    IR_gate_next = 1;
+  
+  TLC_data2[IR_DRV] = IR_gate_next ? IR_duty : 0;
+  
+  if (IR_gate_next != IR_gate_on)
+    TLC5955_UPDATE = 1;
+}
+
+/*******************************************************************************
+* Function: IR_Gate_Latched(void)                                                                    
+*                                                                              
+* Variables:                                                                   
+* N/A                                                                          
+*                                                                              
+* Description:                                                                 
+* This function is called from the Timer1 interrupt after the TLC5955 channels
+* have been written and latched. Only now are the IR transmitters in the state
+* that IR_Gate() picked, so only now is the switch passed on to the ADC 
+* interrupt, which then starts a new scan (IR_Acquire()). The count is changed
+* before the state so that the ADC interrupt can never store a reading under the
+* new state in the middle of a scan.
+*******************************************************************************/
+void IR_Gate_Latched(void)
+{
+  if (IR_gate_next == IR_gate_on)
+    return;
+  
+  IR_gate_count++;
+  IR_gate_on = IR_gate_next;
+}
+
+/*******************************************************************************
+* Function: IR_Snapshot(UINT16 *values)                                                                    
+*                                                                              
+* Variables:                                                                   
+* *values -> Points to IR_SENSORS (24) variables to store the readings in
+*                                                                              
+* Description:                                                                 
+* This function copies the last complete scan of the IR sensors. If a new scan
+* is published while copying, the copy is done again so that all of the readings
+* always come from the same scan. Returns the count of the scan that was copied.
+*******************************************************************************/
+UINT16 IR_Snapshot(UINT16 *values)
+{
+  UINT8 i;
+  UINT16 count;
+  
+  do
+  {
+    count = IR_scan_count;
+    
+    for (i = 0;i < IR_SENSORS;i++)
+      values[i] = IR_scan[IR_scan_ready][i];
+  
+  } while (count != IR_scan_count);
+  
+  return count;
+}
+
+/*******************************************************************************
+* Function: IR_Event_Read(UINT16 *cursor, IR_EVENT *event)                                                                    
+*                                                                              
+* Variables:                                                                   
+* *cursor -> The readers position in the event queue, start it at 0
+* *event -> Where the next event is copied to
+*                                                                              
+* Description:                                                                 
+* This function copies the next sensor change event that the reader hasn't seen
+* yet and returns a 1, or returns a 0 if there are no new events. Every reader
+* (animations, Bluetooth, etc.) keeps its own cursor, so each one sees every event.
+* A reader that falls more than IR_EVENT_SIZE events behind loses the oldest ones.
+* Nothing is locked; if the event is overwritten while it is copied, the copy is
+* done again.
+*******************************************************************************/
+UINT8 IR_Event_Read(UINT16 *cursor, IR_EVENT *event)
+{
+  UINT8 slot;
+  
+  do
+  {
+    if (*cursor == IR_event_head)
+      return 0;
+    
+    //Skip ahead to the oldest event that is still in the queue
+    if ((UINT16) (IR_event_head - *cursor) > IR_EVENT_SIZE)
+      *cursor = IR_event_head - IR_EVENT_SIZE;
+    
+    slot = *cursor & (IR_EVENT_SIZE - 1);
+    
+    event->time = IR_event[slot].time;
+    event->sensor = IR_event[slot].sensor;
+    event->state = IR_event[slot].state;
+    
+  } while ((UINT16) (IR_event_head - *cursor) > IR_EVENT_SIZE);
+  
+  (*cursor)++;
+  
+  return 1;
+}
+
+/*******************************************************************************
+* Function: IR_Event_Drain(UINT16 *cursor)                                                                    
+*                                                                              
+* Variables:                                                                   
+* *cursor -> The readers position in the event queue
+*                                                                              
+* Description:                                                                 
+* This function skips every event that the reader hasn't seen yet. A reader 
+* that is busy (an animation that is still running, etc.) calls this so that it
+* doesn't react to old changes once it starts reading again.
+*******************************************************************************/
+void IR_Event_Drain(UINT16 *cursor)
+{
+  *cursor = IR_event_head;
+}
 
 /*******************************************************************************
 * Function: Enable_IR_Sensors(UINT16 duty)                                                                    
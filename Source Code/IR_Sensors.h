@@ -34,33 +34,156 @@
 #define IR_S1       _LATC1
 #define IR_S2       _LATC2
 
-//This adjusts the sensitivity of the IR sensors. Higher Value = Less Sensitive,
-//Lower Value = More Sensitive (Value has to be between 0 and 1023 of course)
-//BW_THRESHOLD is for the ball washers which we want to be a little more sensitive
-#define IR_THRESHOLD        400
-#define BW_THRESHOLD        150
+//Each sensor keeps its own baseline (the light it reads with nothing over it)
+//which follows slow changes in the ambient light while no cup is present, and
+//an estimate of how noisy it is. A cup is detected when the reading rises above
+//the baseline by IR_NOISE_GAIN standard deviations of that noise, but never by
+//less than IR_MIN_DELTA. A rise above IR_MAX_DELTA is always a detection. The
+//readings are on the 11-bit scale of the background ADC samples (0 - 2046).
+#define IR_MIN_DELTA        80
+#define IR_MAX_DELTA        220
+#define IR_NOISE_GAIN       6
 
-//Determines the # of times each sensor will be read and averaged with.
-//Do not go higher than 64. Explained in more detail in the 'C' file.
-#define CAL_DIV       30
+//Once a sensor is detecting, it only releases when the rise drops below its
+//threshold / 2^IR_HOLD_SHIFT. This keeps readings that sit near the threshold
+//from flickering on and off.
+#define IR_HOLD_SHIFT       1
+
+//The amount of scans in a row (1 - 7) that a sensor has to disagree with its
+//current state before it changes. The sensors are debounced in the ADC interrupt
+//as each scan is published (see IR_Debounce()), which is every ~2ms (8ms / 14ms 
+//to confirm a cup). In lock-in mode there are only ~3 scans every 24.6ms (one
+//Timer1 frame with the transmitters on), so fewer scans are needed (worst case
+//~27ms / ~31ms). The ball washers react on the first scan since a ball only 
+//passes the sensors briefly.
+#define IR_PRESS_COUNT        4
+#define IR_RELEASE_COUNT      7
+#define IR_LOCK_PRESS_COUNT   2
+#define IR_LOCK_RELEASE_COUNT 3
+#define BW_PRESS_COUNT        1
+
+//The bits of the ball washer sensors (20 - 23)
+#define BW_SENSOR_MASK      0x00F00000
+
+//The amount of sensor change events that are kept (must be a power of 2)
+#define IR_EVENT_SIZE       32
+
+//IR_EVENT.state
+#define IR_EVENT_REMOVED    0
+#define IR_EVENT_ADDED      1
+
+//One change in the debounced state of an IR sensor (cup added or removed, ball
+//entering or leaving a ball washer). 'time' is count32 when it was confirmed
+//(the scan that reached the confirm count).
+typedef struct
+{
+  UINT32 time;
+  UINT8 sensor;
+  UINT8 state;
+} IR_EVENT;
+
+//The baseline is stored with IR_BASE_FRAC fraction bits and moves 1/2^IR_BASE_SHIFT
+//of the way to each reading (~20s time constant at one update every 20ms)
+#define IR_BASE_FRAC        16
+#define IR_BASE_SHIFT       10
+
+//The noise variance is stored with IR_NOISE_FRAC fraction bits and moves
+//1/2^IR_NOISE_SHIFT of the way to each squared deviation (~5s time constant)
+#define IR_NOISE_FRAC       4
+#define IR_NOISE_SHIFT      8
+
+//Determines the # of scans (one every ~20ms) that each sensor will be averaged
+//with during calibration. Do not go higher than 250. Explained in more detail
+//in the 'C' file.
+#define CAL_DIV       100
 
 //The delay period in uS after each IR sensor ADC reading; If you are getting
 //inconsistent values try increasing this.
 #define IR_DELAY      20
 
+//The amount of IR sensors that are read in each scan
+#define IR_SENSORS    24
+
+//Set while the IR transmitters are gated (lock-in detection, see IR_Lock_In())
+#define IR_LOCK_IN    FLAG1.b13
+
+//In lock-in mode the IR transmitters are on for one Timer1 frame (8.192ms) and
+//then off for IR_GATE_OFF_FRAMES frames. Must be at least 1.
+#define IR_GATE_OFF_FRAMES    2
+
+//The health of each sensor is checked over windows of IR_HEALTH_WINDOW updates
+//(~10s). A sensor is masked off (never detects) for the next window if its
+//reading didn't move more than IR_STUCK_RANGE, stayed at or above IR_SATURATED,
+//changed state more than IR_FLIP_LIMIT times, or its noise is so high that the
+//threshold is always limited to IR_MAX_DELTA. The stuck and saturated checks are
+//skipped for sensors that detected something during the window (a cup sitting
+//on a pod). Sensors that are masked or unmasked get an event like any other change.
+#define IR_HEALTH_WINDOW    500
+#define IR_STUCK_RANGE      0
+#define IR_SATURATED        2030
+#define IR_FLIP_LIMIT       20
+#define IR_NOISE_LIMIT      (IR_MAX_DELTA / IR_NOISE_GAIN)
+
+//IR_fault[] bits
+#define IR_FAULT_STUCK      0x01
+#define IR_FAULT_SATURATED  0x02
+#define IR_FAULT_NOISY      0x04
+#define IR_FAULT_FLIPPING   0x08
+
+//The calibration is saved in the EEPROM at this address. IR_CAL_VERSION must be
+//changed whenever IR_CAL_RECORD or the way the readings are taken changes, so
+//that an old record is never loaded.
+#define IR_CAL_EE_ADDR      0x0000
+#define IR_CAL_VERSION      0x0002
+
+//Returned by IR_Load_Calibration()
+#define IR_CAL_SUCCESS      0x00
+#define IR_CAL_INVALID      0x01
+#define IR_CAL_MISMATCH     0x02
+
+//The calibration that is saved in the EEPROM. 'crc' covers everything before it.
+typedef struct
+{
+  UINT16 version;
+  UINT16 lock_in;
+  UINT32 baseline[IR_SENSORS];
+  UINT32 noise[IR_SENSORS];
+  UINT16 crc;
+} IR_CAL_RECORD;
+
 /*************************************************
 *                   Macros                       *
 *************************************************/
 #define IR_CHANNEL(x)      {LATC &= 0xFFF8; LATC |= ((x) & 0x0007);} 
 #define IR_INPUTS(x)       {IR1_EN = x; IR2_EN = x; IR3_EN = x;}
 
+//Bits of the 3-bit vertical counter 'c[3]' that are equal to the constant 'k'
+#define VC_EQUAL(c,k)      ((((k) & 1) ? c[0] : ~c[0]) & (((k) & 2) ? c[1] : ~c[1]) & (((k) & 4) ? c[2] : ~c[2]))
+
 /*************************************************
 *              Function Prototypes               *
 *************************************************/
 UINT32 Update_All_Sensors(void);
+void IR_Start_Acquisition(void);
+void IR_Acquire(void);
+void IR_Debounce(volatile UINT16 *scan);
+UINT32 IR_Debounced(void);
+UINT32 IR_Reported(void);
+void IR_Lock_In(UINT8 state);
+void IR_Gate(void);
+void IR_Gate_Latched(void);
+UINT16 IR_Snapshot(UINT16 *values);
+UINT8 IR_Event_Read(UINT16 *cursor, IR_EVENT *event);
+void IR_Event_Drain(UINT16 *cursor);
+UINT32 IR_Health_Update(UINT16 *values, UINT32 detected, UINT32 changed);
 void Enable_IR_Sensors(UINT16 duty);
 
 void Sensor_Calibration(void);
+UINT8 IR_Calibrate(UINT16 *values, UINT32 detected);
+UINT8 IR_Calibration_Status(void);
+UINT8 IR_Save_Calibration(void);
+UINT8 IR_Load_Calibration(void);
+UINT16 IR_Threshold(UINT8 sensor);
 void Set_IR_PWM(UINT16 duty_cycle);
 
 #endif
@@ -21,6 +21,8 @@
 #include "Grid_Setup.h"
 #include "Delay_Setup.h"
 #include "File_Handling.h"
+#include "Spectrum.h"
+#include "VU_Control.h"
 #include <stdio.h>
 #include <stdlib.h>
 
@@ -39,6 +41,8 @@ extern volatile UINT16 ring_brightness;
 extern volatile UINT8 keypress;
 extern volatile UINT32 IR_sensors;
 
+extern volatile UINT32 IR_health;
+
 extern volatile RGB COLOR[11]; 
 
 /*******************************************************************************
@@ -186,12 +190,24 @@ void LCD_Brightness_Rings(void)
 * N/A                                                                          
 *                                                                              
 * Description:                                                                 
-* This function will display a basic screen on the LCD display.                                                                            
+* This function will display the calibrate menu on the LCD display. If any IR
+* sensors are faulty, the health bitmap is shown on the top line.
 *******************************************************************************/
 void LCD_Calibrate_Sensors(void)
 {
+	char str[17];
+	
 	LCD_CLEAR();
-  LCD_Text(0,0,"**** Chexal ****");
+	
+	//If any of the IR sensors are faulty, show which ones (bit 0 = Pod #1)
+	if (IR_health)
+	{
+		sprintf(str,"Faults: %06lX",IR_health);
+		LCD_Text(0,0,str);
+	}
+	else
+  	LCD_Text(0,0,"**** Chexal ****");
+  	
   LCD_Text(0,1,"Calibrate Sensors");
 }  
 
@@ -779,6 +795,8 @@ void Update_LCD_Menu(void)
 *******************************************************************************/
 void Handle_Key_Command(UINT32 cmd)
 {
+	char str[16];
+	
 	//Check to see if a shortcut key was pressed; If one was, change 'pmenu' and 'cmenu'
 	//settings to go to that shortcut menu. 
 	switch (cmd)
@@ -809,8 +827,10 @@ void Handle_Key_Command(UINT32 cmd)
 												//LCD_cmenu = MENU_INACTIVE;
 												
 												VU_Meter++;
+												VU_AUTO = 0;
 												
-												if (VU_Meter > 4)
+												//Mode 5 is the spectrum analyzer
+												if (VU_Meter > (SPECTRUM_ENABLE ? 5 : 4))
 													VU_Meter = 0;
 												
 												cmd = KEY_UNRECOGNIZED; 			          	break;
@@ -1065,10 +1085,13 @@ void Handle_Key_Command(UINT32 cmd)
 													LCD_CLEAR();
 													LCD_Text(0,0,"Calibrating...");
 												
-													//Calibrate the infrared sensors
-													Sensor_Calibration();
-													LCD_Text(0,1,"Complete");
-													Delay_ms(400); 
+													//Start calibrating the infrared sensors if they aren't 
+													//already. Pressing enter again shows the progress.
+													if (IR_Calibration_Status() >= 100)
+														Sensor_Calibration();
+														
+													sprintf(str,"%u%% Complete",IR_Calibration_Status());
+													LCD_Text(0,1,str);
 													
 													break;
 									
@@ -1317,18 +1340,21 @@ void Handle_Key_Command(UINT32 cmd)
 																				LCD_CLEAR();
 																				LCD_Text(0,0,"VU Mode #1 Set");
 																				VU_Meter = 2;
+																				VU_AUTO = 0;
 																				Delay_ms(300);	break;
 																				
 																case MENU_VU_MODE2: 				
 																				LCD_CLEAR();
 																				LCD_Text(0,0,"VU Mode #2 Set");
 																				VU_Meter = 3;
+																				VU_AUTO = 0;
 																				Delay_ms(300);	break;
 																				
 																case MENU_VU_MODE3: 			
 																				LCD_CLEAR();
 																				LCD_Text(0,0,"VU Mode #3 Set");
 																				VU_Meter = 4;
+																				VU_AUTO = 0;
 																				Delay_ms(300);	break;
 																
 																//This is the LCD menu handler. Add your code in the main loop
@@ -1338,12 +1364,16 @@ void Handle_Key_Command(UINT32 cmd)
 																				LCD_Text(0,0,"Back To Default");
 																				LCD_Text(0,1,"Activated");		
   																			VU_Meter = 0;																				
+  																			VU_AUTO = 0;
 																				Delay_ms(300);	break;
 																				
 																case MENU_VU_RANDOM: 				
 																				LCD_CLEAR();
 																				LCD_Text(0,0,"VU Mode Random Set");	
-  																			VU_Meter = 0;								
+  																			
+  																			//Let the VU director pick the modes
+  																			VU_Meter = DIRECTOR_MODE_LOUD;
+  																			VU_AUTO = 1;								
 																				Delay_ms(1000);	break;
 															}	break;
 									
@@ -1352,6 +1382,7 @@ void Handle_Key_Command(UINT32 cmd)
 																	 LCD_cmenu = MENU_INACTIVE;
 																	 LCD_pmenu = MENU_SCREENSAVER; 
 																	 VU_Meter = 0;
+																	 VU_AUTO = 0;
 																	 break;							 	            
 					   		}
 					 }  break;    
@@ -196,6 +196,9 @@ void Fill_Grid(void)
 {
  UINT8 i;
  
+ //The base layer is being redrawn, any retained scene is no longer displayed
+ Scene_Invalidate();
+ 
  //Set all bits (LEDs)
  for (i = 0;i < GRID_Y_MAX;i++)
    grid_row[i] = 0xFFFFFFFF;
@@ -215,6 +218,9 @@ void Clear_Grid(void)
 {
  UINT8 i;
  
+ //The base layer is being redrawn, any retained scene is no longer displayed
+ Scene_Invalidate();
+ 
  //Clear all bits (LEDs)
  for (i = 0;i < GRID_Y_MAX;i++)
    grid_row[i] = 0x00000000;
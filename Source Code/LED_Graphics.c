@@ -41,6 +41,9 @@
 #include "LED_Graphics.h"
 #include "LED_Control.h"
 #include "Grid_Setup.h"
+#include "Grid_Effects.h"
+#include "IR_Sensors.h"
+#include "Table_Map.h"
 #include "VU_Control.h"
 #include "Delay_Setup.h"
 
@@ -68,6 +71,7 @@ extern volatile UINT16 ring_brightness;
 
 extern volatile UINT32 IR_sensors;
 extern volatile UINT32 count32;
+extern volatile UINT32 anim_count;
 extern volatile UINT32 grid_row[12];
 extern volatile UINT32 grid_frame[12];
 
@@ -75,6 +79,9 @@ extern volatile RGB PODn[21];
 extern volatile RGB COLOR[11];
 extern volatile RGB CUSTOM_COLOR1;
 extern volatile RGB CUSTOM_COLOR2;
+
+extern const UINT8 pod_order[MAP_CENTERS][20];
+extern const UINT8 map_max_distance[MAP_CENTERS];
 	
 	
 /*******************************************************************************
@@ -214,6 +221,7 @@ void Animate_On_Detection(void)
 {
   INT8 pod = 0;
   static UINT8 tracker = 0;
+  static UINT16 events = 0;
   
   //If a previous 'cup removal detected' animation is not running check the 
   //pod detection states
@@ -221,7 +229,7 @@ void Animate_On_Detection(void)
   {
     //If a pods detection state has been modified it will be saved in 'pod'
     //Otherwise 'pod' will equal 0, indicating no change
-    pod = On_Pod_Change(IR_sensors);
+    pod = On_Pod_Change(&events);
     
     //If 'pod' is a negative integer it means that the cup has been removed.
     //If the absolute value of 'pod' is between 1 & 10, the removed cup was
@@ -241,8 +249,12 @@ void Animate_On_Detection(void)
   }
   
   //A 'detected cup removal' animation has not finished yet. Allow it to finish
+  //and skip any cups that change in the meantime.
   else
-    tracker = End_Blast(tracker);     
+  {
+    tracker = End_Blast(tracker);
+    IR_Event_Drain(&events);
+  }     
 }  
 	
 	/*******************************************************************************
@@ -268,6 +280,7 @@ void Corner_Circles_On_Detection(void)
 {
   INT8 pod = 0;
   static UINT8 tracker = 0;
+  static UINT16 events = 0;
   
   //If a previous 'cup removal detected' animation is not running check the 
   //pod detection states
@@ -275,7 +288,7 @@ void Corner_Circles_On_Detection(void)
   {
     //If a pods detection state has been modified it will be saved in 'pod'
     //Otherwise 'pod' will equal 0, indicating no change
-    pod = On_Pod_Change(IR_sensors);
+    pod = On_Pod_Change(&events);
     
     //If 'pod' is a negative integer it means that the cup has been removed.
     //If the absolute value of 'pod' is between 1 & 10, the removed cup was
@@ -289,8 +302,12 @@ void Corner_Circles_On_Detection(void)
   }
   
   //A 'detected cup removal' animation has not finished yet. Allow it to finish
+  //and skip any cups that change in the meantime.
   else
-    tracker = Corner_Circles();     
+  {
+    tracker = Corner_Circles();
+    IR_Event_Drain(&events);
+  }     
 } 
 	
 	/*******************************************************************************
@@ -316,6 +333,7 @@ void Scrolling_Arrows_On_Detection(void)
 {
   INT8 pod = 0;
   static UINT8 tracker = 0;
+  static UINT16 events = 0;
   
   //If a previous 'cup removal detected' animation is not running check the 
   //pod detection states
@@ -323,7 +341,7 @@ void Scrolling_Arrows_On_Detection(void)
   {
     //If a pods detection state has been modified it will be saved in 'pod'
     //Otherwise 'pod' will equal 0, indicating no change
-    pod = On_Pod_Change(IR_sensors);
+    pod = On_Pod_Change(&events);
     
     //If 'pod' is a negative integer it means that the cup has been removed.
     //If the absolute value of 'pod' is between 1 & 10, the removed cup was
@@ -340,12 +358,16 @@ void Scrolling_Arrows_On_Detection(void)
     //There was no change in the pods detection states, continue original animation  
     else
     	//Pong_Animation();
-      Scoreboard(IR_sensors)
+      Scoreboard(IR_sensors);
   }
   
   //A 'detected cup removal' animation has not finished yet. Allow it to finish
+  //and skip any cups that change in the meantime.
   else
-    tracker = Scrolling_Arrows(tracker);   
+  {
+    tracker = Scrolling_Arrows(tracker);
+    IR_Event_Drain(&events);
+  }   
 }  
 
 
@@ -921,6 +943,7 @@ UINT8 Cycle_Grid_Animations(void)
   static UINT8 count = 0;
       INT8 pod = 0;
     static UINT8 tracker = 0;
+  static UINT16 events = 0;
 	
   //Set variables to start up state if seq[x] is in reset state
   if (seq[12] == 0xFF)
@@ -940,13 +963,21 @@ UINT8 Cycle_Grid_Animations(void)
     Clear_Grid(); 
   }
   
+  //Move and draw any explosion particles on the effects layer
+  Update_Particles();
+  
   //If a previous 'cup removal detected' animation is not running check the 
   //pod detection states
   if (tracker == 0)
   {  
     //If a pods detection state has been modified it will be saved in 'pod'
     //Otherwise 'pod' will equal 0, indicating no change
-    pod = On_Pod_Change(IR_sensors);
+    pod = On_Pod_Change(&events);
+    
+    //A cup has been removed, start an explosion at that end of the grid. The
+    //explosion is drawn over whichever animation is running.
+    if ((pod < 0) && (abs(pod) < 21))
+      Pod_Explosion(abs(pod));
    
     //If 'pod' is a negative integer it means that the cup has been removed.
     //If the absolute value of 'pod' is between 1 & 10, the removed cup was
@@ -1058,12 +1089,29 @@ UINT8 Cycle_Grid_Animations(void)
       case 8: Box_Grid_In();  
               delay = TIME_DELAY_10S;
               break;
+              
+      case 9: Game_Of_Life();  
+              delay = TIME_DELAY_20S;
+              break;
+              
+      case 10: Falling_Sand();  
+               delay = TIME_DELAY_20S;
+               break;
+               
+      case 11: Rain(1);  
+               delay = TIME_DELAY_10S;
+               break;
+
+      case 12: Grid_Ripple(MAP_TABLE_CENTER);
+               delay = TIME_DELAY_10S;
+               break;
     }
    } 
   }  
     
 
   //A 'detected cup removal' animation has not finished yet. Allow it to finish
+  //and skip any cups that change in the meantime.
   else
   {
     switch (count)
@@ -1072,6 +1120,8 @@ UINT8 Cycle_Grid_Animations(void)
      case 1:  tracker = Scrolling_Arrows(tracker); break;
      case 2: tracker = Corner_Circles(); break;   
     } 
+    
+    IR_Event_Drain(&events);
   }   
     
   //If the specified delay has elapsed, continue to the next sequence
@@ -1080,10 +1130,11 @@ UINT8 Cycle_Grid_Animations(void)
   
   //If all sequences have been performed, reset all sequences
   //and return a 0 to indicate that the routine is finished
-  if (seq[12] > 8)
+  if (seq[12] > 12)
   {
     //Reset the seq[x] variables that are used by the grid animations
     Reset_Sequences(GRID_SEQUENCES);
+    Clear_Particles();
     return 0;
   }  
   
@@ -1175,6 +1226,10 @@ UINT8 Cycle_Pod_Animations(void)
     case 10: Ripple_Out(500,800);
             delay = TIME_DELAY_20S;
             break;
+
+    case 11: Pod_Sweep(300,120);
+            delay = TIME_DELAY_20S;
+            break;
   }  
      
       
@@ -1184,7 +1239,7 @@ UINT8 Cycle_Pod_Animations(void)
   
   //If all sequences have been performed, reset all sequences
   //and return a 0 to indicate that the routine is finished
-  if (seq[13] > 10)
+  if (seq[13] > 11)
   {
     //Reset the seq[x] variables that are used by the pod animations
     Reset_Sequences(POD_SEQUENCES);
@@ -1331,6 +1386,11 @@ UINT8 Cycle_Ring_Animations(void)
     				Crossfade_Rings(); 
             delay = TIME_DELAY_30S;
             break;
+
+    case 3:
+            Ring_Ripple(300,250);
+            delay = TIME_DELAY_30S;
+            break;
   }  
      
       
@@ -1340,7 +1400,7 @@ UINT8 Cycle_Ring_Animations(void)
   
   //If all sequences have been performed, reset all sequences
   //and return a 0 to indicate that the routine is finished
-  if (seq[14] > 2)
+  if (seq[14] > 3)
   {
     //Reset the seq[x] variables that are used by the ring animations
     Reset_Sequences(LED_RING_SEQUENCES);
@@ -1387,7 +1447,7 @@ UINT8 Box_Grid_In(void)
   {  
     //Update the sequence and 'tmark' which is used for timing
     last_seq = seq[20];
-    tmark = count32;
+    tmark = anim_count;
     
     //Clear grid each time a new circle is to be drawn 
     Clear_Grid(); 
@@ -1405,7 +1465,7 @@ UINT8 Box_Grid_In(void)
   } 
   
   //If the specified delay has elapsed, continue to the next sequence
-  if (Time_Check(&tmark,delay))
+  if (Anim_Check(&tmark,delay))
     seq[20]++;
     
   //If the animation has completed reset seq[20] to its default state and
@@ -1453,7 +1513,7 @@ UINT8 Checkers(void)
   {
     //Update the sequence and 'tmark' which is used for timing
     last_seq = seq[16];
-    tmark = count32;
+    tmark = anim_count;
     
     //Display 1st checker pattern on grid
     if (((seq[16]+1) % 2) == 0)
@@ -1474,7 +1534,7 @@ UINT8 Checkers(void)
   }  
       
   //If the specified delay has elapsed, continue to the next sequence
-  if (Time_Check(&tmark,delay))
+  if (Anim_Check(&tmark,delay))
     seq[16]++;
   
   //If all sequences have been performed, reset seq[x]
@@ -1523,7 +1583,7 @@ UINT8 Circle_Out(void)
   {  
     //Update the sequence and 'tmark' which is used for timing
     last_seq = seq[3];
-    tmark = count32;
+    tmark = anim_count;
     
     //Clear grid each time a new circle is to be drawn 
     Clear_Grid(); 
@@ -1539,7 +1599,7 @@ UINT8 Circle_Out(void)
   } 
   
   //If the specified delay has elapsed, continue to the next sequence
-  if (Time_Check(&tmark,delay))
+  if (Anim_Check(&tmark,delay))
     seq[3]++;
     
   //If the animation has completed reset seq[3] to its default state and
@@ -1602,7 +1662,7 @@ UINT8 Color_Throb(RGB outside_color, RGB inside_color)
   {
     //Update the sequence and 'tmark' which is used for timing
     last_seq = seq[10];
-    tmark = count32;
+    tmark = anim_count;
     
     //Start circulating around the triangle of the RGB pods and lighting
     //each one up full brightness at a time before dimming it again
@@ -1646,7 +1706,7 @@ UINT8 Color_Throb(RGB outside_color, RGB inside_color)
   }  
       
   //If the specified delay has elapsed, continue to the next sequence
-  if (Time_Check(&tmark,delay))
+  if (Anim_Check(&tmark,delay))
     seq[10]++;
   
   //If all sequences have been performed, reset seq[10] and return a 0
@@ -1699,7 +1759,7 @@ UINT8 Corner_Circles(void)
   {  
     //Update the sequence and 'tmark' which is used for timing
     last_seq = seq[5];
-    tmark = count32;
+    tmark = anim_count;
     
     //Clear grid for new circle on each sequence lower than 50
     if (seq[5] < 50)
@@ -1739,7 +1799,7 @@ UINT8 Corner_Circles(void)
   } 
   
   //If the specified delay has elapsed, continue to the next sequence
-  if (Time_Check(&tmark,delay))
+  if (Anim_Check(&tmark,delay))
     seq[5]++;
     
   //If all sequences have been performed, reset seq[5]
@@ -1787,7 +1847,7 @@ UINT8 Crossfade_Rings(void)
   {
     //Update the sequence and 'tmark' which is used for timing
     last_seq = seq[18];
-    tmark = count32;
+    tmark = anim_count;
 	 
 	  //Use the seq[18] to determine which set of rings to update
 	  switch (seq[18])
@@ -1891,7 +1951,7 @@ UINT8 Crossfade_Rings(void)
   }
   
   //If the specified delay has elapsed, continue to the next sequence
-  if (Time_Check(&tmark,delay))
+  if (Anim_Check(&tmark,delay))
     seq[18]++;
   
   //If all sequences have been performed, reset seq[18] to its default value 
@@ -1941,7 +2001,7 @@ UINT8 Cycle_Colors(void)
   {
     //Update the sequence and 'tmark' which is used for timing
     last_seq = seq[1];
-    tmark = count32;
+    tmark = anim_count;
     
     //Update pods to the next color defined in RGB COLOR (Globals.h)
 		for (i = 0;i < 20;i++)
@@ -1949,7 +2009,7 @@ UINT8 Cycle_Colors(void)
   }
   
   //If the specified delay has elapsed, continue to the next sequence
-  if (Time_Check(&tmark,delay))
+  if (Anim_Check(&tmark,delay))
     seq[1]++; 
     
   //If all sequences have been performed, reset seq[1] to its default state and
@@ -1997,7 +2057,7 @@ UINT8 Cycle_Rings(void)
   {
     //Update the sequence and 'tmark' which is used for timing
     last_seq = seq[2];
-    tmark = count32;
+    tmark = anim_count;
 	 
 	  //Use the seq[2] to determine which set of rings to update
 	  switch (seq[2])
@@ -2092,7 +2152,7 @@ UINT8 Cycle_Rings(void)
   }
   
   //If the specified delay has elapsed, continue to the next sequence
-  if (Time_Check(&tmark,delay))
+  if (Anim_Check(&tmark,delay))
     seq[2]++;
   
   //If all sequences have been performed, reset seq[2] to its default value 
@@ -2143,7 +2203,7 @@ UINT8 Fade_Pod_Colors(void)
   {
     //Update the sequence and 'tmark' which is used for timing
     last_seq = seq[4];
-    tmark = count32;
+    tmark = anim_count;
       
     switch (seq[4])
     {
@@ -2238,7 +2298,7 @@ UINT8 Fade_Pod_Colors(void)
   }
     
   //If the specified delay has elapsed, continue to the next sequence
-  if (Time_Check(&tmark,delay))
+  if (Anim_Check(&tmark,delay))
     seq[4]++;
   
   //If all sequences have been performed, reset seq[4] and return a 0
@@ -2456,7 +2516,7 @@ UINT8 Draw_Sine(UINT8 state)
   {  
     //Update the sequence and 'tmark' which is used for timing
     last_seq = seq[6];
-    tmark = count32;
+    tmark = anim_count;
 		
 		//Check to see if the inverted sine wave or the original sine wave 
 		//has been selected and modify the grid accordingly
@@ -2465,8 +2525,6 @@ UINT8 Draw_Sine(UINT8 state)
 	  else
 	    Clear_Grid();	
 	  
-	  _T3IE = 0;
-	  
 	  //Draw a new sine wave across the grid
 		for (i = 31;i >= 0;i--)
 		{
@@ -2480,14 +2538,12 @@ UINT8 Draw_Sine(UINT8 state)
 			LED_Pixel(i,data[i]+1,state);
 		}
 		
-	  _T3IE = 1;
-		
 		//Update the grid
 	  UPDATE_FRAME();
 	}
 		
 	//If the specified delay has elapsed, continue to the next sequence
-  if (Time_Check(&tmark,delay))
+  if (Anim_Check(&tmark,delay))
     seq[6]++;
     
   //If all sequences have been performed, reset seq[6] to its default value
@@ -2546,7 +2602,7 @@ UINT8 Dual_Wave(UINT8 state)
   {  
     //Update the sequence and 'tmark' which is used for timing
     last_seq = seq[21];
-    tmark = count32;
+    tmark = anim_count;
 		
 		//Check to see if the inverted sine wave or the original sine wave 
 		//has been selected and modify the grid accordingly
@@ -2555,8 +2611,6 @@ UINT8 Dual_Wave(UINT8 state)
 	  else
 	    Clear_Grid();	
 	  
-	  _T3IE = 0;
-	  
 	  //Draw a new sine wave across the grid
 		for (i = 31;i >= 0;i--)
 		{
@@ -2583,14 +2637,12 @@ UINT8 Dual_Wave(UINT8 state)
 			LED_Pixel(i,data[i]+1,state);
 		}
 		
-	  _T3IE = 1;
-		
 		//Update the grid
 	  UPDATE_FRAME();
 	}
 		
 	//If the specified delay has elapsed, continue to the next sequence
-  if (Time_Check(&tmark,delay))
+  if (Anim_Check(&tmark,delay))
     seq[21]++;
     
   //If all sequences have been performed, reset seq[21] to its default value
@@ -2662,7 +2714,7 @@ UINT8 End_Blast(UINT8 side)
   if (side == MASTER_SIDE)
   {    	
      //If the seq has changed, update the new sequence
-    if (Time_Check(&tmark,delay))
+    if (Anim_Check(&tmark,delay))
     { 
       //Reset all of the LED grid data     			  			 
       Clear_Grid();
@@ -2734,7 +2786,7 @@ UINT8 End_Blast(UINT8 side)
   else if (side == SECONDARY_SIDE)  
   {   	
    //If the seq has changed, update the new sequence
-    if (Time_Check(&tmark,delay))
+    if (Anim_Check(&tmark,delay))
     { 
       //Reset all of the LED grid data     			  			 
       Clear_Grid();
@@ -2860,7 +2912,7 @@ UINT8 Exploding_Circle(void)
    }
   
   //If the specified delay has elapsed, continue to the next sequence
-  if (Time_Check(&tmark,delay))
+  if (Anim_Check(&tmark,delay))
     seq[0]++; 
  
   //If all sequences have been performed, reset seq[0] to its default state
@@ -2876,91 +2928,37 @@ UINT8 Exploding_Circle(void)
 }
 
 /*******************************************************************************
-* Function: On_Pod_Change(void)                                                                  
+* Function: On_Pod_Change(UINT16 *cursor)                                                                  
 *                                                                              
 * Variables:                                                                   
-* N/A
+* *cursor -> The callers position in the sensor event queue (start it at 0)
 *                                 
 * Description:                                                                 
-* This function will check the sensor data that is passed into it and return a
-* 0 if no pods have changed since the previous run. If a pod has changed, the 
+* This function will read the next cup change event from the IR sensors and return
+* a 0 if no pods have changed since the previous call. If a pod has changed, the 
 * pods numerical value (1 - 20) will be returned from the function and if the returned
 * value is a positive value it means that the cup has been added to the table. If
 * the returned value is a negative value, it means that the cup has been removed
-* from the table. To eliminate false detections, the cup that is detected must
-* be consistent for POLL_AMOUNT # of loops, if the sensed values changed before
-* the polling times out it will assume that it was a false detect and discard the
-* previous data.                                                                      
+* from the table. Every change is queued, so cups that are moved at the same time
+* are returned one after the other on the following calls. The sensors are already
+* debounced in IR_Debounce(), so the change is returned right away. Ball washer
+* sensors are skipped. A caller that is busy should drain its cursor with
+* IR_Event_Drain() so that it doesn't react to old changes afterwards.
 *******************************************************************************/
-INT8 On_Pod_Change(UINT32 sensor_bits)
+INT8 On_Pod_Change(UINT16 *cursor)
 {
-  static UINT32 last_sensor_values = 0x00000000;
-  static INT8 saved_pod = 0;
-  static UINT16 pod_counter = 0;
-  UINT8 i;
-  UINT32 change;
+  IR_EVENT event;
   
-  //See if a pod has been removed or added to the table
-  change = sensor_bits ^ last_sensor_values;
-  
-  //If the values have changed from the last loop through, reset
-  //the variables used for polling the IR sensors
-  if (change)
+  while (IR_Event_Read(cursor,&event))
   {
-  	pod_counter = 0;
-  	saved_pod = 0;
-  }	
-  
-  //If a cup has been removed, return the pods # as a negative integer  
-  if (change &  ~sensor_bits)
-  {
-	  //A pod has been modified, start the polling counter
-	  pod_counter = 1;
-	  
-    //Find which pod has been changed (The lower the pod #, the higher
-    //the priority it has).
-    for (i = 0;i < 20;i++)
+    if (event.sensor < 20)
     {
-      //Find the pod that has been modified and return the data that will
-      //equal the pods number. The value will be a negative integer to 
-      //inform us that the cup has been removed from the table.
-      if ((change >> i) & 0x00000001)
-        saved_pod = (-(i+1));
-    }
-  }  
-  
-  //If a pod has been added, return the pods # as a positive integer    
-  else if (change & sensor_bits)
-  {
-	  //A pod has been modified, start the polling counter
-	  pod_counter = 1;
-	  
-    //Find which pod has been changed (The lower the pod #, the higher
-    //the priority it has).    
-    for (i = 0;i < 20;i++)
-    {
-      //Find the pod that has been modified and return the data that will
-      //equal the pods number. The value will be a positive integer to inform
-      //us that the cup has been added from the table.
-      if ((change >> i) & 0x00000001)
-        saved_pod = (i+1);
-    }
-  }        
-  
-  //Update the variable that we use to keep track of the sensor values  
-  last_sensor_values = sensor_bits;  
-  
-  //If the polling has started for a sensor, increment it each time
- 	if (pod_counter >= 1)
-		pod_counter++;
-	
-	//If the polling amount has been reached, reset the polling counter and
-	//return the value of the pod along with the detection state
-  if (pod_counter > POLL_AMOUNT)
-  {
-	  pod_counter = 0;
-	  return saved_pod;
-	}
+      if (event.state == IR_EVENT_ADDED)
+        return (event.sensor + 1);
+      else
+        return (-(event.sensor + 1));  
+    }    
+  }    
 
   //No pods have changed, return 0 
   return 0;   
@@ -3030,7 +3028,7 @@ UINT8 Pyramid_Chase(void)
   {
     //Update the sequence and 'tmark' which is used for timing
     last_seq = seq[9];
-    tmark = count32;
+    tmark = anim_count;
     
     //Update the corresponding pods on each side of the table
     Fade_Pod(seq[9]+1,COLOR[i],fade_rate); 
@@ -3038,7 +3036,7 @@ UINT8 Pyramid_Chase(void)
   }  
       
   //If the specified delay has elapsed, continue to the next sequence
-  if (Time_Check(&tmark,delay))
+  if (Anim_Check(&tmark,delay))
     seq[9]++;
   
   //If all sequences have been performed, reset the variables and increment
@@ -3103,7 +3101,7 @@ UINT8 Ring_Chase(void)
   {
     //Update the sequence and 'tmark' which is used for timing
     last_seq = seq[19];
-    tmark = count32;
+    tmark = anim_count;
     
 	  //Cycle through the rings
 	  for (i = 0;i < 12;i++)
@@ -3124,7 +3122,7 @@ UINT8 Ring_Chase(void)
   }
   
   //If the specified delay has elapsed, continue to the next sequence
-  if (Time_Check(&tmark,delay))
+  if (Anim_Check(&tmark,delay))
     seq[19]++;
   
   //If all sequences have been performed, reset seq[19] to its default value 
@@ -3139,17 +3137,88 @@ UINT8 Ring_Chase(void)
   return 1;  
 }
 
+/*******************************************************************************
+* Function: Ring_Ripple(UINT16 fade_rate, UINT16 delay)
+*
+* Variables:
+* fade_rate -> This adjusts the rate of fade for the LED rings
+* delay -> This adjusts the amount of delay between each band of the ripple
+*
+* Description:
+* This animation will dim all of the LED rings and then send a ripple of light
+* out from the middle of the table. The rings closest to the middle (13 & 14)
+* light up first, then each band of rings further out lights up as the band
+* behind it dims again. The rings are found with the table map (see Table_Map.c).
+* This function will not modify the ball washer LED rings if BW_ACTIVE is equal
+* to 1.
+*
+* This animation must be continually looped through with the main code. If the
+* animation finishes, the function will return a 0. If the animation is still in
+* progress it will return a 1.
+*******************************************************************************/
+UINT8 Ring_Ripple(UINT16 fade_rate, UINT16 delay)
+{
+  static UINT8 last_seq = 0xFF;
+  static UINT32 tmark = 0;
+  UINT8 min = 28;
+  UINT8 width = 16;
+  UINT8 r;
+
+  //If this flag is cleared, the function is just beginning. Set all variables
+  //back to default values.
+  if (seq[30] == 0xFF)
+  {
+    seq[30] = 0;
+    last_seq = 0xFF;
+
+    //Start with every ring dimmed
+    Map_Fade_Rings(MAP_TABLE_CENTER,0,0xFF,min,fade_rate);
+  }
+
+  //If the seq has changed, move the ripple out one band
+  if (seq[30] != last_seq)
+  {
+    //Update the sequence and 'tmark' which is used for timing
+    last_seq = seq[30];
+    tmark = anim_count;
+
+    r = seq[30] * width;
+
+    //Dim the band that the ripple is leaving and light the next one
+    if (seq[30] > 0)
+      Map_Fade_Rings(MAP_TABLE_CENTER,r - width,r,min,fade_rate);
+
+    Map_Fade_Rings(MAP_TABLE_CENTER,r,r + width,ring_brightness,fade_rate);
+  }
+
+  //If the specified delay has elapsed, continue to the next sequence
+  if (Anim_Check(&tmark,delay))
+    seq[30]++;
+
+  //Once the ripple has passed the furthest ring, reset seq[30] to its default
+  //value and return a 0
+  if ((seq[30] * width) > (map_max_distance[MAP_TABLE_CENTER] + width))
+  {
+    seq[30] = 0xFF;
+    return 0;
+  }
+
+  //The animation has not completed yet, return a 1
+  return 1;
+}
+
 /*******************************************************************************
 * Function: Ripple_Out(UINT16 fade_rate, UINT16 delay)                                                                    
 *                                                                              
 * Variables:                                                                   
 * fade_rate -> This adjusts the rate of fade for the RGB pods                                                                            
-* delay -> This adjusts the amount of delay between each color                                                                            
+* delay -> This adjusts the amount of delay between each ring of the ripple                                                                            
 *                                                                              
 * Description:                                                                 
 * This function will set the middle RGB pods (5 & 15) to a color first and
-* then the surrounding pods will slowly fade into the same color. The process
-* will then repeat with a new color producing a rippling effect.     
+* then the surrounding pods will slowly fade into the same color, one ring of
+* pods at a time. The pods are found with the table map (see Table_Map.c). The
+* process will then repeat with a new color producing a rippling effect.     
 *
 * This animation must be continually looped through with the main code. If the 
 * animation finishes, the function will return a 0. If the animation is still in
@@ -3159,6 +3228,14 @@ UINT8 Ripple_Out(UINT16 fade_rate, UINT16 delay)
 {  
 	static UINT8 last_seq = 0xFF;
   static UINT32 tmark = 0;
+  UINT8 step;
+  
+  //The colors of each ripple
+  UINT8 colors[8] = {RED,GREEN,BLUE,WHITE,VIOLET,ORANGE,CYAN,MAGENTA};
+  
+  //The distances from the middle of each pyramid that make up each ring of
+  //pods. The middle pod and then all of the pods around it.
+  UINT8 band[3] = {0,4,0xFF};
 	
   //Check to see if the animation is starting/restarting
   if (seq[8] == 0xFF)
@@ -3172,229 +3249,16 @@ UINT8 Ripple_Out(UINT16 fade_rate, UINT16 delay)
   {
     //Update the sequence and 'tmark' which is used for timing
     last_seq = seq[8];
-    tmark = count32;
+    tmark = anim_count;
     
-    //This statement determines what colors and RGB pods fade at what sequences
-    switch (seq[8])
-    {
-      case 0:  
-              Fade_Pod(5,COLOR[RED],fade_rate);  
-              Fade_Pod(15,COLOR[RED],fade_rate);   
-              break;
-              
-      case 1: 
-              Fade_Pod(20,COLOR[RED],fade_rate);  
-              Fade_Pod(19,COLOR[RED],fade_rate);    
-              Fade_Pod(18,COLOR[RED],fade_rate);    
-              Fade_Pod(17,COLOR[RED],fade_rate);       
-              Fade_Pod(16,COLOR[RED],fade_rate);    
-              Fade_Pod(14,COLOR[RED],fade_rate);     
-              Fade_Pod(13,COLOR[RED],fade_rate);   
-              Fade_Pod(12,COLOR[RED],fade_rate);   
-              Fade_Pod(11,COLOR[RED],fade_rate); 
-              Fade_Pod(10,COLOR[RED],fade_rate);  
-              Fade_Pod(9,COLOR[RED],fade_rate);    
-              Fade_Pod(8,COLOR[RED],fade_rate);    
-              Fade_Pod(7,COLOR[RED],fade_rate);       
-              Fade_Pod(6,COLOR[RED],fade_rate);    
-              Fade_Pod(4,COLOR[RED],fade_rate);     
-              Fade_Pod(3,COLOR[RED],fade_rate);   
-              Fade_Pod(2,COLOR[RED],fade_rate);   
-              Fade_Pod(1,COLOR[RED],fade_rate);   
-              break;
-              
-      case 10:  
-              Fade_Pod(5,COLOR[ORANGE],fade_rate); 
-              Fade_Pod(15,COLOR[ORANGE],fade_rate);   
-              break;
-              
-      case 11: 
-              Fade_Pod(20,COLOR[ORANGE],fade_rate);  
-              Fade_Pod(19,COLOR[ORANGE],fade_rate);    
-              Fade_Pod(18,COLOR[ORANGE],fade_rate);    
-              Fade_Pod(17,COLOR[ORANGE],fade_rate);       
-              Fade_Pod(16,COLOR[ORANGE],fade_rate);    
-              Fade_Pod(14,COLOR[ORANGE],fade_rate);     
-              Fade_Pod(13,COLOR[ORANGE],fade_rate);   
-              Fade_Pod(12,COLOR[ORANGE],fade_rate);   
-              Fade_Pod(11,COLOR[ORANGE],fade_rate);   
-              Fade_Pod(10,COLOR[ORANGE],fade_rate);  
-              Fade_Pod(9,COLOR[ORANGE],fade_rate);    
-              Fade_Pod(8,COLOR[ORANGE],fade_rate);    
-              Fade_Pod(7,COLOR[ORANGE],fade_rate);       
-              Fade_Pod(6,COLOR[ORANGE],fade_rate);    
-              Fade_Pod(4,COLOR[ORANGE],fade_rate);     
-              Fade_Pod(3,COLOR[ORANGE],fade_rate);   
-              Fade_Pod(2,COLOR[ORANGE],fade_rate);   
-              Fade_Pod(1,COLOR[ORANGE],fade_rate);   
-              break;
-              
-      case 12:  
-              Fade_Pod(5,COLOR[CYAN],fade_rate); 
-              Fade_Pod(15,COLOR[CYAN],fade_rate);   
-              break;
-              
-      case 13:        
-              Fade_Pod(20,COLOR[CYAN],fade_rate);  
-              Fade_Pod(19,COLOR[CYAN],fade_rate);    
-              Fade_Pod(18,COLOR[CYAN],fade_rate);    
-              Fade_Pod(17,COLOR[CYAN],fade_rate);       
-              Fade_Pod(16,COLOR[CYAN],fade_rate);    
-              Fade_Pod(14,COLOR[CYAN],fade_rate);     
-              Fade_Pod(13,COLOR[CYAN],fade_rate);   
-              Fade_Pod(12,COLOR[CYAN],fade_rate);   
-              Fade_Pod(11,COLOR[CYAN],fade_rate);   
-              Fade_Pod(10,COLOR[CYAN],fade_rate);  
-              Fade_Pod(10,COLOR[CYAN],fade_rate);  
-              Fade_Pod(9,COLOR[CYAN],fade_rate);    
-              Fade_Pod(8,COLOR[CYAN],fade_rate);    
-              Fade_Pod(7,COLOR[CYAN],fade_rate);       
-              Fade_Pod(6,COLOR[CYAN],fade_rate);    
-              Fade_Pod(4,COLOR[CYAN],fade_rate);     
-              Fade_Pod(3,COLOR[CYAN],fade_rate);   
-              Fade_Pod(2,COLOR[CYAN],fade_rate);   
-              Fade_Pod(1,COLOR[CYAN],fade_rate);   
-              break;
-              
-      case 8:  
-              Fade_Pod(5,COLOR[VIOLET],fade_rate);  
-              Fade_Pod(15,COLOR[VIOLET],fade_rate);   
-              break;
-              
-      case 9:         
-              Fade_Pod(20,COLOR[VIOLET],fade_rate);  
-              Fade_Pod(19,COLOR[VIOLET],fade_rate);    
-              Fade_Pod(18,COLOR[VIOLET],fade_rate);    
-              Fade_Pod(17,COLOR[VIOLET],fade_rate);       
-              Fade_Pod(16,COLOR[VIOLET],fade_rate);    
-              Fade_Pod(14,COLOR[VIOLET],fade_rate);     
-              Fade_Pod(13,COLOR[VIOLET],fade_rate);   
-              Fade_Pod(12,COLOR[VIOLET],fade_rate);   
-              Fade_Pod(11,COLOR[VIOLET],fade_rate);   
-              Fade_Pod(10,COLOR[VIOLET],fade_rate); 
-              Fade_Pod(10,COLOR[VIOLET],fade_rate);  
-              Fade_Pod(9,COLOR[VIOLET],fade_rate);    
-              Fade_Pod(8,COLOR[VIOLET],fade_rate);    
-              Fade_Pod(7,COLOR[VIOLET],fade_rate);       
-              Fade_Pod(6,COLOR[VIOLET],fade_rate);    
-              Fade_Pod(4,COLOR[VIOLET],fade_rate);     
-              Fade_Pod(3,COLOR[VIOLET],fade_rate);   
-              Fade_Pod(2,COLOR[VIOLET],fade_rate);   
-              Fade_Pod(1,COLOR[VIOLET],fade_rate);   
-              break;
-              
-      case 2:  
-              Fade_Pod(5,COLOR[GREEN],fade_rate);   
-              Fade_Pod(15,COLOR[GREEN],fade_rate);   
-              break;
-              
-      case 3:         
-              Fade_Pod(20,COLOR[GREEN],fade_rate);  
-              Fade_Pod(19,COLOR[GREEN],fade_rate);    
-              Fade_Pod(18,COLOR[GREEN],fade_rate);    
-              Fade_Pod(17,COLOR[GREEN],fade_rate);       
-              Fade_Pod(16,COLOR[GREEN],fade_rate);    
-              Fade_Pod(14,COLOR[GREEN],fade_rate);     
-              Fade_Pod(13,COLOR[GREEN],fade_rate);   
-              Fade_Pod(12,COLOR[GREEN],fade_rate);   
-              Fade_Pod(11,COLOR[GREEN],fade_rate);   
-              Fade_Pod(10,COLOR[GREEN],fade_rate); 
-              Fade_Pod(10,COLOR[GREEN],fade_rate);  
-              Fade_Pod(9,COLOR[GREEN],fade_rate);    
-              Fade_Pod(8,COLOR[GREEN],fade_rate);    
-              Fade_Pod(7,COLOR[GREEN],fade_rate);       
-              Fade_Pod(6,COLOR[GREEN],fade_rate);    
-              Fade_Pod(4,COLOR[GREEN],fade_rate);     
-              Fade_Pod(3,COLOR[GREEN],fade_rate);   
-              Fade_Pod(2,COLOR[GREEN],fade_rate);   
-              Fade_Pod(1,COLOR[GREEN],fade_rate);   
-              break;
-              
-      case 6:  
-              Fade_Pod(5,COLOR[WHITE],fade_rate); 
-              Fade_Pod(15,COLOR[WHITE],fade_rate);   
-              break;
-              
-      case 7:         
-              Fade_Pod(20,COLOR[WHITE],fade_rate);  
-              Fade_Pod(19,COLOR[WHITE],fade_rate);    
-              Fade_Pod(18,COLOR[WHITE],fade_rate);    
-              Fade_Pod(17,COLOR[WHITE],fade_rate);       
-              Fade_Pod(16,COLOR[WHITE],fade_rate);    
-              Fade_Pod(14,COLOR[WHITE],fade_rate);     
-              Fade_Pod(13,COLOR[WHITE],fade_rate);   
-              Fade_Pod(12,COLOR[WHITE],fade_rate);   
-              Fade_Pod(11,COLOR[WHITE],fade_rate);   
-              Fade_Pod(10,COLOR[WHITE],fade_rate); 
-              Fade_Pod(10,COLOR[WHITE],fade_rate);  
-              Fade_Pod(9,COLOR[WHITE],fade_rate);    
-              Fade_Pod(8,COLOR[WHITE],fade_rate);    
-              Fade_Pod(7,COLOR[WHITE],fade_rate);    
-              Fade_Pod(6,COLOR[WHITE],fade_rate);     
-              Fade_Pod(4,COLOR[WHITE],fade_rate);     
-              Fade_Pod(3,COLOR[WHITE],fade_rate);   
-              Fade_Pod(2,COLOR[WHITE],fade_rate);   
-              Fade_Pod(1,COLOR[WHITE],fade_rate);   
-              break;
-              
-      case 4:  
-              Fade_Pod(5,COLOR[BLUE],fade_rate);   
-              Fade_Pod(15,COLOR[BLUE],fade_rate);   
-              break;
-              
-      case 5:         
-              Fade_Pod(20,COLOR[BLUE],fade_rate);  
-              Fade_Pod(19,COLOR[BLUE],fade_rate);    
-              Fade_Pod(18,COLOR[BLUE],fade_rate);    
-              Fade_Pod(17,COLOR[BLUE],fade_rate);       
-              Fade_Pod(16,COLOR[BLUE],fade_rate);    
-              Fade_Pod(14,COLOR[BLUE],fade_rate);     
-              Fade_Pod(13,COLOR[BLUE],fade_rate);   
-              Fade_Pod(12,COLOR[BLUE],fade_rate);   
-              Fade_Pod(11,COLOR[BLUE],fade_rate);   
-              Fade_Pod(10,COLOR[BLUE],fade_rate); 
-              Fade_Pod(10,COLOR[BLUE],fade_rate);  
-              Fade_Pod(9,COLOR[BLUE],fade_rate);    
-              Fade_Pod(8,COLOR[BLUE],fade_rate);    
-              Fade_Pod(7,COLOR[BLUE],fade_rate);    
-              Fade_Pod(6,COLOR[BLUE],fade_rate);      
-              Fade_Pod(4,COLOR[BLUE],fade_rate);     
-              Fade_Pod(3,COLOR[BLUE],fade_rate);   
-              Fade_Pod(2,COLOR[BLUE],fade_rate);   
-              Fade_Pod(1,COLOR[BLUE],fade_rate);   
-              break;
-              
-      case 14:  
-              Fade_Pod(5,COLOR[MAGENTA],fade_rate);   
-              Fade_Pod(15,COLOR[MAGENTA],fade_rate);   
-              break;
-              
-      case 15:         
-              Fade_Pod(20,COLOR[MAGENTA],fade_rate);  
-              Fade_Pod(19,COLOR[MAGENTA],fade_rate);    
-              Fade_Pod(18,COLOR[MAGENTA],fade_rate);    
-              Fade_Pod(17,COLOR[MAGENTA],fade_rate);       
-              Fade_Pod(16,COLOR[MAGENTA],fade_rate);    
-              Fade_Pod(14,COLOR[MAGENTA],fade_rate);     
-              Fade_Pod(13,COLOR[MAGENTA],fade_rate);   
-              Fade_Pod(12,COLOR[MAGENTA],fade_rate);   
-              Fade_Pod(11,COLOR[MAGENTA],fade_rate);   
-              Fade_Pod(10,COLOR[MAGENTA],fade_rate); 
-              Fade_Pod(10,COLOR[MAGENTA],fade_rate);  
-              Fade_Pod(9,COLOR[MAGENTA],fade_rate);    
-              Fade_Pod(8,COLOR[MAGENTA],fade_rate);    
-              Fade_Pod(7,COLOR[MAGENTA],fade_rate);    
-              Fade_Pod(6,COLOR[MAGENTA],fade_rate);     
-              Fade_Pod(4,COLOR[MAGENTA],fade_rate);     
-              Fade_Pod(3,COLOR[MAGENTA],fade_rate);   
-              Fade_Pod(2,COLOR[MAGENTA],fade_rate);   
-              Fade_Pod(1,COLOR[MAGENTA],fade_rate);   
-              break;
-    }
+    //Each color takes two sequences, one for each ring of pods
+    step = seq[8] % 2;
+    
+    Map_Fade_Pods(MAP_PYRAMIDS,band[step],band[step+1],COLOR[colors[seq[8] / 2]],fade_rate);
   }  
       
   //If the specified delay has elapsed, continue to the next sequence
-  if (Time_Check(&tmark,delay))
+  if (Anim_Check(&tmark,delay))
     seq[8]++;
   
   //If all sequences have been performed, reset seq[8] and return a 0
@@ -3409,6 +3273,70 @@ UINT8 Ripple_Out(UINT16 fade_rate, UINT16 delay)
 }	
 
 
+/*******************************************************************************
+* Function: Pod_Sweep(UINT16 fade_rate, UINT16 delay)
+*
+* Variables:
+* fade_rate -> This adjusts the rate of fade for the RGB pods
+* delay -> This adjusts the amount of delay between each pod of the sweep
+*
+* Description:
+* This function will sweep a color across the RGB pods (1-20), one pod at a
+* time, from one end of the table to the other. The pods are taken in order of
+* their distance from the end of the table (see Table_Map.c). The next color
+* then sweeps back from the other end of the table.
+*
+* This animation must be continually looped through with the main code. If the
+* animation finishes, the function will return a 0. If the animation is still in
+* progress it will return a 1.
+*******************************************************************************/
+UINT8 Pod_Sweep(UINT16 fade_rate, UINT16 delay)
+{
+  static UINT8 last_seq = 0xFF;
+  static UINT32 tmark = 0;
+  UINT8 sweep;
+  UINT8 center;
+
+  //The colors of each sweep
+  UINT8 colors[4] = {CYAN,MAGENTA,YELLOW,BLUE};
+
+  //Check to see if the animation is starting/restarting
+  if (seq[31] == 0xFF)
+  {
+    seq[31] = 0;
+    last_seq = 0xFF;
+  }
+
+  //Check to see if a new sequence has to be updated
+  if (seq[31] != last_seq)
+  {
+    //Update the sequence and 'tmark' which is used for timing
+    last_seq = seq[31];
+    tmark = anim_count;
+
+    //Each color takes 20 sequences, one for each pod. Every other sweep starts
+    //from the SECONDARY SIDE end of the table.
+    sweep = seq[31] / 20;
+    center = (sweep % 2) ? MAP_SECONDARY_END : MAP_MASTER_END;
+
+    Fade_Pod(pod_order[center][seq[31] % 20],COLOR[colors[sweep]],fade_rate);
+  }
+
+  //If the specified delay has elapsed, continue to the next sequence
+  if (Anim_Check(&tmark,delay))
+    seq[31]++;
+
+  //If all sequences have been performed, reset seq[31] and return a 0
+  if (seq[31] > 79)
+  {
+    seq[31] = 0xFF;
+    return 0;
+  }
+
+  //If the animation hasn't finished, return a 1
+  return 1;
+}
+
 /*******************************************************************************
 * Function: Scoreboard(UINT32 pod_sensors)                                                                  
 *                                                                              
@@ -3420,15 +3348,22 @@ UINT8 Ripple_Out(UINT16 fade_rate, UINT16 delay)
 * determine the score for each side of the table. It will then draw a scoreboard
 * on the LED grid and display the master sides score and the secondary sides score.
 * Each pod counts as 1 point, so each team starts out at 10 points. The first team
-* to get their opponent down to 0 wins the match.                                                                    
+* to get their opponent down to 0 wins the match.
+*
+* The scoreboard is a retained scene. It is only drawn again when the score
+* changes or when another animation has drawn over it. When a score changes, the
+* new score flashes SCORE_FLASH_FRAMES times before it stays on the grid.                                                                    
 *******************************************************************************/ 
 void Scoreboard(UINT32 sensor_bits)
 {
   UINT8 i;
-  char temp_str[2];
+  char temp_str[3];
   char master = 0;
   char secondary = 0;
+  UINT32 score;
   static UINT32 timer = 0;
+  static UINT8 flash_side = 0;
+  static GRID_SCENE scene = {SCENE_SCOREBOARD,0,0,0};
   
   //Add up the score for each side
 	for (i = 0;i < 10;i++)
@@ -3436,15 +3371,38 @@ void Scoreboard(UINT32 sensor_bits)
 	  master += ((sensor_bits >> i) & 0x01);
 	  secondary += ((sensor_bits >> (i+10)) & 0x01);
 	} 
+	
+	//Pack both scores together; These are the only inputs that the scene is drawn from
+	score = ((UINT32)master << 8) | (UINT32)secondary;
   
-  //Update the scoreboard if the score has changed since the last loop through
-  if (Time_Check(&timer,50))
+  //Only check the scoreboard every 50ms
+  if (!Time_Check(&timer,50))
+    return;
+    
+  //If a score has changed while the scoreboard is displayed, flash the new score
+  if (scene.valid && score != scene.input)
   {
-	  timer = count32;
+	  flash_side = 0;
 	  
-	  //Clear the grid data
-	  Clear_Grid();
+	  if ((UINT8)(scene.input >> 8) != master)
+	    flash_side |= MASTER_SIDE;
+	    
+	  if ((UINT8)scene.input != secondary)
+	    flash_side |= SECONDARY_SIDE;
+	    
+	  Scene_Transition(&scene,SCORE_FLASH_FRAMES * 2);
+	}
+  
+  //Nothing has changed since the scoreboard was last drawn, leave the grid alone
+  if (!Scene_Needs_Render(&scene,score))
+    return;
 	  
+  //Clear the grid data
+  Clear_Grid();
+  
+  //Hide the score that is flashing on every other frame of the transition 
+  if (!(scene.transition & 0x01) || !(flash_side & MASTER_SIDE))
+  {
 	  //If the master side has 10 points, adjust the text location and display it	
 	  if (master == 10)
 		  Set_Text(2,2,"10");
@@ -3459,7 +3417,10 @@ void Scoreboard(UINT32 sensor_bits)
 			//Set the masters score
 		  Set_Text(5,2,temp_str);
 		}  
+	}
 		
+  if (!(scene.transition & 0x01) || !(flash_side & SECONDARY_SIDE))
+  {
 	  //If the secondary side has 10 points, adjust the text location and display it	
 	  if (secondary == 10)
 		  Set_Text(18,2,"10");
@@ -3474,16 +3435,19 @@ void Scoreboard(UINT32 sensor_bits)
 			//Set the secondarys score
 		  Set_Text(21,2,temp_str);
 		}  
-		
-		//Draw two dividing lines down the center of the table and draw a 1-pixel border 
-		for (i = 0;i < GRID_Y_MAX;i++)
-		  grid_row[i] |= 0x00018000; 	
-		  
-		Draw_Border(1);
-		
-		//Update the LED grid
-		UPDATE_FRAME();
 	}
+		
+	//Draw two dividing lines down the center of the table and draw a 1-pixel border 
+	for (i = 0;i < GRID_Y_MAX;i++)
+	  grid_row[i] |= 0x00018000; 	
+	  
+	Draw_Border(1);
+	
+	//Update the LED grid
+	UPDATE_FRAME();
+	
+	//The grid now displays the scoreboard
+	Scene_Rendered(&scene);
 }      
 
 /*******************************************************************************
@@ -3519,8 +3483,9 @@ UINT8 Set_Scrolling_Text(char text[64])
   //Reset the index variable to keep track of the location in the array
   str_index = 0;
   
-  //Clear the rows of the grid
+  //Clear the rows of the grid and the text layer that the text scrolls across
   Clear_Grid();
+  Layer_Clear(LAYER_TEXT);
   
   //Activate the scrolling operation
   SCROLL_ACTIVE = 1;
@@ -3541,11 +3506,34 @@ UINT8 Set_Scrolling_Text(char text[64])
 * This function will write text onto the LED grid array starting at location (px,py).                                                                      
 *******************************************************************************/  
 void Set_Text(UINT8 px, UINT8 py, char text[12])
+{
+  Layer_Set_Text(LAYER_BASE,px,py,text);
+}
+
+/*******************************************************************************
+* Function: Layer_Set_Text(UINT8 layer, UINT8 px, UINT8 py, char text[12])                                                                  
+*                                                                              
+* Variables:                                                                   
+* layer -> The grid layer that the text is written into
+* px -> Starting x-coordinate where the text is placed                         
+* py -> Starting y-coordinate where the text is placed                                                                                      
+* text[12] -> The text that is to be displayed                                                                         
+*                                                                              
+* Description:                                                                 
+* This function will write text onto one of the LED grid layers starting at 
+* location (px,py). Writing into LAYER_TEXT allows text to be displayed on top
+* of an animation without the animation having to redraw it.                                                                      
+*******************************************************************************/  
+void Layer_Set_Text(UINT8 layer, UINT8 px, UINT8 py, char text[12])
 {
   UINT8 i;
   UINT8 j;
   UINT8 length;
   UINT16 lookup;
+  UINT32 *rows;
+  
+  //Get the rows of the layer that the text will be written into
+  rows = Layer_Rows(layer);
   
   //Get the length of the string
   length = strlen(text);
@@ -3561,7 +3549,7 @@ void Set_Text(UINT8 px, UINT8 py, char text[12])
 		//will exceed the size of the grid.
 		if (j > 26)
 		{
-			UPDATE_FRAME();
+			Layer_Update(layer);
 			return;
 		}	
 				
@@ -3569,13 +3557,13 @@ void Set_Text(UINT8 px, UINT8 py, char text[12])
   	lookup = (text[i] - 32) * 7;
   	
   	//Display the character on the grid
-	  grid_row[py]   |= ((UINT32)font_5x7[lookup] << j);
-	  grid_row[py+1] |= ((UINT32)font_5x7[++lookup] << j);
-	  grid_row[py+2] |= ((UINT32)font_5x7[++lookup] << j);
-	  grid_row[py+3] |= ((UINT32)font_5x7[++lookup] << j);
-	  grid_row[py+4] |= ((UINT32)font_5x7[++lookup] << j);	
-	  grid_row[py+5] |= ((UINT32)font_5x7[++lookup] << j);	
-	  grid_row[py+6] |= ((UINT32)font_5x7[++lookup] << j);	
+	  rows[py]   |= ((UINT32)font_5x7[lookup] << j);
+	  rows[py+1] |= ((UINT32)font_5x7[++lookup] << j);
+	  rows[py+2] |= ((UINT32)font_5x7[++lookup] << j);
+	  rows[py+3] |= ((UINT32)font_5x7[++lookup] << j);
+	  rows[py+4] |= ((UINT32)font_5x7[++lookup] << j);	
+	  rows[py+5] |= ((UINT32)font_5x7[++lookup] << j);	
+	  rows[py+6] |= ((UINT32)font_5x7[++lookup] << j);	
 	}	 
 } 
 
@@ -3611,7 +3599,7 @@ UINT8 Scrolling_Arrows(UINT8 direction)
   {    
     //Update the sequence and 'tmark' which is used for timing
     last_seq = seq[22];
-    tmark = count32;
+    tmark = anim_count;
 
     if (direction == SCROLL_GRID_LEFT)
     {
@@ -3633,7 +3621,7 @@ UINT8 Scrolling_Arrows(UINT8 direction)
   }
         
   //If the specified delay has elapsed, continue to the next sequence
-  if (Time_Check(&tmark,delay))
+  if (Anim_Check(&tmark,delay))
     seq[22]++;  
       
   //If all sequences have been performed, reset the variables and increment
@@ -3663,22 +3651,26 @@ UINT8 Scrolling_Arrows(UINT8 direction)
 *                                                                              
 * Description:                                                                 
 * This function will update the location of the scrolling text on the LED grid
-* and display it. It is set up in the Timer3 interrupt routine.                                                                             
+* and display it. It is called every 1ms from the INT1 interrupt routine.                                                                             
 *******************************************************************************/ 
 UINT8 Update_Text(void)
 {
   UINT8 i;
   UINT16 loc;
   UINT16 scroll_delay = 45;
+  UINT32 *text_row;
   
   static UINT8 j = 0;
   static UINT32 tmark = 0;
   
+  //The text is scrolled across its own layer so that it does not disturb grid_row
+  text_row = Layer_Rows(LAYER_TEXT);
+  
   //Check to see if the specified amount of time has elapsed
-  if (Time_Check(&tmark,scroll_delay))
+  if (Anim_Check(&tmark,scroll_delay))
   {
     //Update the counter for the next operation
-    tmark = count32; 
+    tmark = anim_count; 
     
     //If the index has been set above 223, finish scrolling the last of the text
     if (str_index > 223)
@@ -3696,13 +3688,13 @@ UINT8 Update_Text(void)
       }  
       
       //Shift the characters to the left again
-      Shift_Grid_Left(1); 
+      Layer_Shift_Left(LAYER_TEXT,1); 
       
       //Decrease the count which keeps track of the shifts left til the end of the grid     
       str_index--; 
       
       //Update the LED grid
-      UPDATE_FRAME();    
+      Layer_Update(LAYER_TEXT);    
       
       //Return value which indicates scroll operation is still in progress
       return 1;  
@@ -3712,7 +3704,7 @@ UINT8 Update_Text(void)
     if (j < 5)
     {  
       //Shift text one location to the left
-      Shift_Grid_Left(1);
+      Layer_Shift_Left(LAYER_TEXT,1);
       
       //Calculate the start location for the current letter in the font array
       loc = (global_str[str_index] - 32) * 7; 
@@ -3722,7 +3714,7 @@ UINT8 Update_Text(void)
       {
         //Start each character at the far right location of the LED grid
         if (font_5x7[loc+i] & (1 << j)) 
-          grid_row[i+2] |= 0x80000000; 
+          text_row[i+2] |= 0x80000000; 
       }  
       
       //Increment j to read the next columns of bits pertaining to the current character  
@@ -3744,11 +3736,11 @@ UINT8 Update_Text(void)
         str_index = 0xFF;
       
       //Put a space between the characters  
-      Shift_Grid_Left(1);
+      Layer_Shift_Left(LAYER_TEXT,1);
     }
     
     //Update the LED grid
-    UPDATE_FRAME();
+    Layer_Update(LAYER_TEXT);
   }  
   
   //Return a scroll in progress value
@@ -3813,7 +3805,7 @@ UINT8 Pong_Animation(void)
   //On first run, this will always prove true. After the first loop through
   //it will only loop through once the time interval has passed and the next
   //step can be executed.
-  if (Time_Check(&tmark,GAME_SPEED))
+  if (Anim_Check(&tmark,GAME_SPEED))
   {
     //Update the sequence, clear the grid and redraw the border but
     //do not update the grid as we will update all of it at once at
@@ -3947,6 +3939,10 @@ void Reset_Sequences(UINT8 mode)
             seq[21] = 0xFF;
             seq[22] = 0xFF;
             seq[24] = 0xFF;
+            seq[26] = 0xFF;
+            seq[27] = 0xFF;
+            seq[28] = 0xFF;
+            seq[29] = 0xFF;
             break;
             
     //Reset all seq[x] variables that are used for RGB pod animations      
@@ -3958,6 +3954,7 @@ void Reset_Sequences(UINT8 mode)
             seq[10] = 0xFF;
             seq[13] = 0xFF;
             seq[24] = 0xFF;
+            seq[31] = 0xFF;
             break;
             
     //Reset all seq[x] variables that are used for LED Ring animations      
@@ -3966,6 +3963,7 @@ void Reset_Sequences(UINT8 mode)
             seq[14]  = 0xFF;
             seq[18]  = 0xFF;
             seq[19]  = 0xFF;
+            seq[30]  = 0xFF;
             break;
   }           
 }
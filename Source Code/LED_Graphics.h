@@ -33,10 +33,8 @@
 //Used in Pod_Detect() to set the faderates of the pods
 #define POD_DETECT_FADERATE 40
 
-//The amount of times that the IR sensor will be read and has to be 
-//consistent before returning a sensor detected value. Used in
-//On_Pod_Change(). This is used to prevent false detections.
-#define POLL_AMOUNT         25
+//The amount of times that a new score flashes on the scoreboard
+#define SCORE_FLASH_FRAMES  3
 
 //LED Ring max and min values for various animations
 //Added fade rate too
@@ -143,6 +141,7 @@ void Check_Grid_Animation(UINT8 *selection);
 void Check_Ring_Animation(UINT8 *selection);
 void LED_Pixel(UINT8 px, UINT8 py, UINT8 state);
 void Set_Text(UINT8 px, UINT8 py, char text[12]);
+void Layer_Set_Text(UINT8 layer, UINT8 px, UINT8 py, char text[12]);
 void Draw_Circle(UINT8 px, UINT8 py, UINT8 radius);
 void Draw_Rect(UINT8 px, UINT8 py, UINT8 sx, UINT8 sy);  
 void Pod_Detect(UINT32 detection, RGB off_color, RGB on_color);
@@ -150,7 +149,7 @@ void Ball_Washer(UINT8 bw, UINT16 fan_speed, UINT16 pump_speed);
 
 UINT8 Intro_Animation(void);
 
-INT8 On_Pod_Change(UINT32 sensor_bits);  
+INT8 On_Pod_Change(UINT16 *cursor);  
 
 UINT8 Checkers(void);  
 UINT8 Ring_Chase(void);
@@ -173,6 +172,8 @@ UINT8 Cycle_Grid_Animations(void);
 UINT8 Cycle_Ring_Animations(void);
 UINT8 Scrolling_Arrows(UINT8 direction);
 UINT8 Ripple_Out(UINT16 fade_rate, UINT16 delay);
+UINT8 Pod_Sweep(UINT16 fade_rate, UINT16 delay);
+UINT8 Ring_Ripple(UINT16 fade_rate, UINT16 delay);
 UINT8 Set_Scrolling_Text(char text[64]);
 UINT8 Color_Throb(RGB outside_color, RGB inside_color);    
 
@@ -7,6 +7,12 @@
 * Description:                                                                 
 * This file contains the functions that are used to control the VU Meter Attachment
 * and read the seven different frequencies from the microphone or the AUX input.                                                                                 
+*
+* The MSGEQ7 is read in the background. Each time a new AN3 sample is ready (every
+* 250us), the ADC interrupt calls MSGEQ7_Acquire(), which steps through the bands.
+* One tick stores the band that has been on the output for the whole sample and
+* raises the strobe, the next tick lowers it to put the next band on the output.
+* All 7 bands are read every 3.5ms (~285Hz) and published in 'msgeq7_band[7]'.
 *******************************************************************************/
 
 #ifndef MSGEQ7_SETUP_C
@@ -17,9 +23,110 @@
 #include "MSGEQ7_Setup.h"
 #include "ADC_Setup.h"
 #include "LED_Control.h"
+#include <stdio.h>
 
 extern volatile UINT32 count32;
+extern volatile UINT16 anim_period;
+extern volatile UINT8 anim_beat;
 extern volatile RGB COLOR[11];
+extern volatile UINT16 adc_sample[4];
+
+//The last complete reading of all 7 bands, when it was read (count32) and a
+//count that increments each time a new one is published. 'msgeq7_fill' holds
+//the bands that are being read.
+volatile UINT16 msgeq7_band[7];
+volatile UINT32 msgeq7_time = 0;
+volatile UINT16 msgeq7_count = 0;
+UINT16 msgeq7_fill[7];
+
+//20 * log10(x) in 1/4 dB for each ADC value (0 for 0)
+const UINT8 msgeq7_db[1024] = 
+{
+	0,0,24,38,48,56,62,68,72,76,80,83,86,89,92,94,
+	96,98,100,102,104,106,107,109,110,112,113,115,116,117,118,119,
+	120,121,123,124,125,125,126,127,128,129,130,131,131,132,133,134,
+	134,135,136,137,137,138,139,139,140,140,141,142,142,143,143,144,
+	144,145,146,146,147,147,148,148,149,149,150,150,150,151,151,152,
+	152,153,153,154,154,154,155,155,156,156,156,157,157,157,158,158,
+	159,159,159,160,160,160,161,161,161,162,162,162,163,163,163,164,
+	164,164,165,165,165,165,166,166,166,167,167,167,167,168,168,168,
+	169,169,169,169,170,170,170,170,171,171,171,171,172,172,172,172,
+	173,173,173,173,174,174,174,174,175,175,175,175,175,176,176,176,
+	176,177,177,177,177,177,178,178,178,178,178,179,179,179,179,179,
+	180,180,180,180,180,181,181,181,181,181,182,182,182,182,182,182,
+	183,183,183,183,183,184,184,184,184,184,184,185,185,185,185,185,
+	185,186,186,186,186,186,186,187,187,187,187,187,187,188,188,188,
+	188,188,188,188,189,189,189,189,189,189,190,190,190,190,190,190,
+	190,191,191,191,191,191,191,191,192,192,192,192,192,192,192,193,
+	193,193,193,193,193,193,193,194,194,194,194,194,194,194,195,195,
+	195,195,195,195,195,195,196,196,196,196,196,196,196,196,197,197,
+	197,197,197,197,197,197,197,198,198,198,198,198,198,198,198,199,
+	199,199,199,199,199,199,199,199,200,200,200,200,200,200,200,200,
+	200,201,201,201,201,201,201,201,201,201,201,202,202,202,202,202,
+	202,202,202,202,203,203,203,203,203,203,203,203,203,203,204,204,
+	204,204,204,204,204,204,204,204,205,205,205,205,205,205,205,205,
+	205,205,205,206,206,206,206,206,206,206,206,206,206,206,207,207,
+	207,207,207,207,207,207,207,207,207,208,208,208,208,208,208,208,
+	208,208,208,208,209,209,209,209,209,209,209,209,209,209,209,209,
+	210,210,210,210,210,210,210,210,210,210,210,210,211,211,211,211,
+	211,211,211,211,211,211,211,211,211,212,212,212,212,212,212,212,
+	212,212,212,212,212,212,213,213,213,213,213,213,213,213,213,213,
+	213,213,213,214,214,214,214,214,214,214,214,214,214,214,214,214,
+	214,215,215,215,215,215,215,215,215,215,215,215,215,215,215,216,
+	216,216,216,216,216,216,216,216,216,216,216,216,216,217,217,217,
+	217,217,217,217,217,217,217,217,217,217,217,217,218,218,218,218,
+	218,218,218,218,218,218,218,218,218,218,218,219,219,219,219,219,
+	219,219,219,219,219,219,219,219,219,219,219,220,220,220,220,220,
+	220,220,220,220,220,220,220,220,220,220,220,221,221,221,221,221,
+	221,221,221,221,221,221,221,221,221,221,221,221,222,222,222,222,
+	222,222,222,222,222,222,222,222,222,222,222,222,222,223,223,223,
+	223,223,223,223,223,223,223,223,223,223,223,223,223,223,224,224,
+	224,224,224,224,224,224,224,224,224,224,224,224,224,224,224,224,
+	224,225,225,225,225,225,225,225,225,225,225,225,225,225,225,225,
+	225,225,225,226,226,226,226,226,226,226,226,226,226,226,226,226,
+	226,226,226,226,226,226,226,227,227,227,227,227,227,227,227,227,
+	227,227,227,227,227,227,227,227,227,227,228,228,228,228,228,228,
+	228,228,228,228,228,228,228,228,228,228,228,228,228,228,228,229,
+	229,229,229,229,229,229,229,229,229,229,229,229,229,229,229,229,
+	229,229,229,229,230,230,230,230,230,230,230,230,230,230,230,230,
+	230,230,230,230,230,230,230,230,230,231,231,231,231,231,231,231,
+	231,231,231,231,231,231,231,231,231,231,231,231,231,231,231,232,
+	232,232,232,232,232,232,232,232,232,232,232,232,232,232,232,232,
+	232,232,232,232,232,232,233,233,233,233,233,233,233,233,233,233,
+	233,233,233,233,233,233,233,233,233,233,233,233,233,233,234,234,
+	234,234,234,234,234,234,234,234,234,234,234,234,234,234,234,234,
+	234,234,234,234,234,234,235,235,235,235,235,235,235,235,235,235,
+	235,235,235,235,235,235,235,235,235,235,235,235,235,235,235,236,
+	236,236,236,236,236,236,236,236,236,236,236,236,236,236,236,236,
+	236,236,236,236,236,236,236,236,236,237,237,237,237,237,237,237,
+	237,237,237,237,237,237,237,237,237,237,237,237,237,237,237,237,
+	237,237,237,238,238,238,238,238,238,238,238,238,238,238,238,238,
+	238,238,238,238,238,238,238,238,238,238,238,238,238,238,239,239,
+	239,239,239,239,239,239,239,239,239,239,239,239,239,239,239,239,
+	239,239,239,239,239,239,239,239,239,239,240,240,240,240,240,240,
+	240,240,240,240,240,240,240,240,240,240,240,240,240,240,240,240,
+	240,240,240,240,240,240,240,241,241,241,241,241,241,241,241,241
+};
+
+//The boost of each band in 1/4 dB, defined in MSGEQ7_Setup.h
+const UINT8 msgeq7_weight[7] = {CH0_WEIGHT,CH1_WEIGHT,CH2_WEIGHT,CH3_WEIGHT,
+															  CH4_WEIGHT,CH5_WEIGHT,CH6_WEIGHT};
+
+//The level (0 - 31) for each 1/4 dB below the top of a band (see MSGEQ7_Set_Range())
+UINT8 msgeq7_map[256];
+
+//The top (peak envelope) of each band from MSGEQ7_Auto_Adjust(a,b), 16.16 fixed
+//point. It is also used by VU_Director() to follow the loudness of the music.
+UINT32 msgeq7_top[7];
+
+//The last beat found by MSGEQ7_Tempo() (see MSGEQ7_Beat()). 'beat_strength' is
+//how far the onset rose above its threshold, and 'beat_bpm' is the tempo of the
+//music in beats per minute (0 until it has been found).
+UINT16 beat_count = 0;
+UINT8 beat_type = 0;
+UINT8 beat_strength = 0;
+UINT32 beat_time = 0;
+UINT16 beat_bpm = 0;
 
 /*******************************************************************************
 * Function: MSGEQ7_Init(void)                                                                     
@@ -28,7 +135,8 @@ extern volatile RGB COLOR[11];
 * N/A                                                                           
 *                                                                               
 * Description:                                                                  
-* This function will reset the MSGEQ7, allowing us to begin controlling it.
+* This function will reset the MSGEQ7, allowing us to begin controlling it, and
+* sets the default dynamic range of the levels.
 *******************************************************************************/
 void MSGEQ7_Init(void)
 {
@@ -39,6 +147,57 @@ void MSGEQ7_Init(void)
   MSG_RESET = 1;
   Delay_us(1);
   MSG_RESET = 0;
+  
+  MSGEQ7_Set_Range(VU_RANGE_DEFAULT);
+}
+
+/*******************************************************************************
+* Function: MSGEQ7_Acquire(void)                                                                     
+*                                                                               
+* Variables:                                                                    
+* N/A                                                                           
+*                                                                               
+* Description:                                                                  
+* This function is called from the ADC interrupt every time a new sample of AN3
+* is ready (every 250us). It takes two calls to read each band. The first stores
+* the band that was on the output for the whole sample and raises the strobe. The
+* second lowers the strobe, which puts the next band on the output (it settles in
+* 36us, well before the next sample is taken). Once all 7 bands have been read, 
+* they are published.
+*******************************************************************************/
+void MSGEQ7_Acquire(void)
+{
+  static UINT8 band = 0;
+  static UINT8 strobe = 1;
+  
+  UINT8 i;
+  
+  //Put the next band on the output
+  if (strobe)
+  {
+    MSG_STROBE = 0;
+    strobe = 0;
+    return;
+  }  
+  
+  //Store the current bands reading (back on the 0 - 1023 scale that the VU
+  //levels use) and strobe the MSGEQ7 on to the next band
+  msgeq7_fill[band] = (adc_sample[3] + 1) >> 1;
+  
+  MSG_STROBE = 1;
+  strobe = 1;
+  
+  //All 7 bands have been read, publish them
+  if (++band > 6)
+  {
+    band = 0;
+    
+    for (i = 0;i < 7;i++)
+      msgeq7_band[i] = msgeq7_fill[i];
+      
+    msgeq7_time = count32;
+    msgeq7_count++;
+  }   
 }
 
 /*******************************************************************************
@@ -48,7 +207,10 @@ void MSGEQ7_Init(void)
 * *channel -> Points to seven 16-bit variables to store the ADC readings
 *                                                                               
 * Description:                                                                  
-* This function will save all seven ADC readings in a specified variable array.
+* This function will save all seven ADC readings in a specified variable array
+* and return the time they were read (count32). The readings are the last set 
+* that was read in the background, so this function doesn't wait. If a new set is
+* published while copying, the copy is done again.
 * The order of the frequencies that are stored are:
 *
 * channel[0] -> 63Hz Band
@@ -60,28 +222,76 @@ void MSGEQ7_Init(void)
 * channel[6] -> 16kHz Band
 *
 *******************************************************************************/
-void MSGEQ7_Read(UINT16 *channel)
+UINT32 MSGEQ7_Read(UINT16 *channel)
 {
   UINT8 i;
-  UINT16 buf[4];
+  UINT16 count;
+  UINT32 time;
   
-  //Strobe the MSGEQ7 seven times to read all seven frequency bands
-  for (i = 0;i < 7;i++)
+  do
   {
-	  //Set strobe to idle state and allow it enough time to settle
-    MSG_STROBE = 0;
-    Delay_us(80);
-    
-    //Read AN3 on the PIC, which is connected to the VU meter attachment
-    ADC_Read_SS(buf);
+    count = msgeq7_count;
     
-    //Store the current bands reading
-    channel[i] = buf[3];
+    for (i = 0;i < 7;i++)
+      channel[i] = msgeq7_band[i];
     
-    //Strobe the MSGEQ7 so that it will read the next frequency band on the next loop
-    MSG_STROBE = 1;
-    Delay_us(80);
-  }  
+    time = msgeq7_time;
+      
+  } while (count != msgeq7_count);
+  
+  return time;
+}
+
+/*******************************************************************************
+* Function: MSGEQ7_Follow(UINT32 env, UINT32 target, UINT16 dt, UINT16 time)
+*
+* Variables:
+* env -> The current value of the envelope (16.16 fixed point)
+* target -> The value the envelope is moving towards (16.16 fixed point)
+* dt -> The time since the envelope was last moved (ms)
+* time -> The time it takes the envelope to reach the target (ms)
+*
+* Description:
+* This function moves an envelope towards a target by dt / time of the distance
+* between them and returns the new value. Moving by elapsed time keeps the speed
+* of the envelopes the same however often they are updated.
+*******************************************************************************/
+UINT32 MSGEQ7_Follow(UINT32 env, UINT32 target, UINT16 dt, UINT16 time)
+{
+	INT32 diff;
+
+	if (dt >= time)
+		return target;
+
+	diff = (INT32) target - (INT32) env;
+
+	//Divide first so the multiply can't overflow
+	return env + (diff / (INT32) time) * dt;
+}
+
+/*******************************************************************************
+* Function: MSGEQ7_Set_Range(UINT8 range)
+*
+* Variables:
+* range -> The dynamic range of the levels in dB (1 - 63)
+*
+* Description:
+* This function builds the table that MSGEQ7_Auto_Adjust(a,b) uses to turn how
+* far a reading is below the top of its band into a level. The top of the band
+* is level 31 and 'range' dB below it is level 0. A small range makes the VU 
+* meters jumpy, a large one shows more of the quiet parts of the music.
+*******************************************************************************/
+void MSGEQ7_Set_Range(UINT8 range)
+{
+	UINT16 i;
+	UINT16 steps;
+	
+	for (i = 0;i < 256;i++)
+	{
+		steps = ((UINT32) i * (VU_STEPS - 1)) / ((UINT16) range << 2);
+		
+		msgeq7_map[i] = (steps >= (VU_STEPS - 1)) ? 0 : ((VU_STEPS - 1) - steps);
+	}
 }
 
 /*******************************************************************************
@@ -92,81 +302,367 @@ void MSGEQ7_Read(UINT16 *channel)
 * *level -> Stores each frequency bands audio intensity on a scale of 0 - 31                                                                   
 *                                                                               
 * Description:                                                                  
-* This function will take the raw ADC readings from the MSGEQ7, compensate for a
-* specific offset with each band to remove noise, then calculate the intensity
-* of each frequency, assigning it a value between 0 - 31, with 31 being the highest
-* intensity.                                                                               
+* This function will take the raw ADC readings from the MSGEQ7 and calculate the
+* intensity of each frequency, assigning it a value between 0 - 31, with 31 being
+* the highest intensity. Each band has three envelopes: its top (peaks), its floor
+* (lowest readings) and the height of its noise, which is learned while the band
+* is silent. Readings below the floor + noise are masked off. The rest is put on
+* a dB scale below the top (see MSGEQ7_Set_Range()), using one table lookup for
+* the reading and one for the top, so quiet passages still show. All of the envelopes move by the
+* time since the last call (see the AGC_ constants), so after a long pause they
+* restart at the current readings. The levels are not smoothed here, that is 
+* done for the VU animations by VU_Update().
 *******************************************************************************/
 void MSGEQ7_Auto_Adjust(UINT16 *chan, UINT16 *level)
 {
-	static float max[7];
-	static float min[7];
+	static UINT32 tmark = 0;
+	static UINT32 bottom[7];
+	static UINT32 noise[7];
 
 	UINT8 i;
-	UINT16 diff;
-	UINT16 raw_value;
-	static UINT16 last_level[7] = {0,0,0,0,0,0,0};
-	float step;
+	UINT16 dt;
+	UINT32 value;
+	UINT32 gate;
+	UINT32 range;
+	INT16 db;
 	
-	//These offsets are defined is MSGEQ&_Setup.h
-	UINT8 offset[7] = {CH0_OFFSET,CH1_OFFSET,CH2_OFFSET,CH3_OFFSET,   
-										 CH4_OFFSET,CH5_OFFSET,CH6_OFFSET};
+	//Find the time since the last call. The longest envelope time is enough to
+	//reset all of them.
+	if ((count32 - tmark) > AGC_FLOOR_RISE_TIME)
+		dt = AGC_FLOOR_RISE_TIME;
+	else
+		dt = count32 - tmark;
+		
+	tmark = count32;
 	
 	//Cycle through each of the seven channels
 	for (i = 0;i < 7;i++)
 	{
-		//Each time the channel value is less than max, lower the max threshold a bit
-		if (chan[i] < max[i])
-			max[i] *= 0.999;
+		value = (UINT32) chan[i] << AGC_FRAC;
 		
-		//A new max value has exceeded the old threshold, set the new value	
+		//Follow the peaks quickly and fall back slowly
+		if (value > msgeq7_top[i])
+			msgeq7_top[i] = MSGEQ7_Follow(msgeq7_top[i],value,dt,AGC_ATTACK_TIME);
 		else
-			max[i] = chan[i];
+			msgeq7_top[i] = MSGEQ7_Follow(msgeq7_top[i],value,dt,AGC_RELEASE_TIME);
 		
+		//Follow the lowest readings quickly and rise slowly
+		if (value < bottom[i])
+			bottom[i] = MSGEQ7_Follow(bottom[i],value,dt,AGC_FLOOR_FALL_TIME);
+		else
+			bottom[i] = MSGEQ7_Follow(bottom[i],value,dt,AGC_FLOOR_RISE_TIME);
 		
-		//Each time the channel value is higher than min, raise the min threshold a bit
-		if (chan[i] > min[i])
-			min[i] *= 1.01;
+		if (bottom[i] > ((UINT32) AGC_MAX_FLOOR << AGC_FRAC))
+			bottom[i] = (UINT32) AGC_MAX_FLOOR << AGC_FRAC;
 		
-		//A lower value than the previous min threshold has been captured; Set new value	
-		else
-			min[i] = chan[i];
-			
-		if (max[i] < 100)
-		  max[i] = 100;
+		//The band is silent, learn how high its noise reaches above the floor
+		if (msgeq7_top[i] < (bottom[i] + ((UINT32) AGC_SILENCE << AGC_FRAC)))
+		{
+			gate = (value > bottom[i]) ? (value - bottom[i]) : 0;
 			
-		if (min[i] > 50)
-		  min[i] = 50;
+			if (gate > noise[i])
+				noise[i] = gate;
+			else
+				noise[i] = MSGEQ7_Follow(noise[i],gate,dt,AGC_NOISE_TIME);
+		}
+		
+		//Mask off any values that could just be noise
+		gate = bottom[i] + noise[i];
+		
+		//Find the range between the noise and the top
+		range = (msgeq7_top[i] > gate) ? (msgeq7_top[i] - gate) : 0;
+		
+		if (range < ((UINT32) AGC_MIN_RANGE << AGC_FRAC))
+			range = (UINT32) AGC_MIN_RANGE << AGC_FRAC;
 		
-		//Mask off any values that could just be noise. This was set up through trial and error
-		if ((chan[i] - min[i]) < offset[i])
-				chan[i] = min[i];
+		//Find how far the reading is below the top (1/4 dB) and look up its level
+		if (value > gate)
+		{
+			db = msgeq7_db[range >> AGC_FRAC] - msgeq7_db[(value - gate) >> AGC_FRAC] - msgeq7_weight[i];
+			
+			if (db < 0)
+				db = 0;
+			else if (db > 255)
+				db = 255;
+			
+			level[i] = msgeq7_map[db];
+		}
+			
+		else
+			level[i] = 0;
+	}
+}	
+  
+/*******************************************************************************
+* Function: MSGEQ7_Tempo(UINT16 *level)                                                                     
+*                                                                               
+* Variables:                                                                    
+* *level -> The seven frequency band levels (0 - 31) from MSGEQ7_Auto_Adjust(a,b)
+*                                                                               
+* Description:                                                                  
+* This function finds the beats in the music. Every TEMPO_UPDATE_TIME ms the
+* rise (flux) of the bass bands (kicks) and of the 1kHz - 6.25kHz bands (snares)
+* are added up, each band being measured from the highest of its last few
+* readings. Each sum is checked against its own threshold, which follows the
+* running average and deviation of that sum, so the detection adapts to how
+* busy the music is. Each onset is published as a beat (see MSGEQ7_Beat()) and
+* added to the tempo (see MSGEQ7_Tempo_Update()). Once the tempo is found, 
+* 'beat_bpm' is set and the beats are passed on to the animation clock (see 
+* Anim_Clock_Tick()). Call this function each time new band levels have been read.
+*******************************************************************************/
+void MSGEQ7_Tempo(UINT16 *level)
+{
+	static UINT32 tmark = 0;
+	static UINT32 beat_mark = 0;
+	static UINT32 hit_mark[2] = {0,0};
+	static UINT16 history[TEMPO_LAG][7];
+	static UINT16 mean[2] = {0,0};
+	static UINT16 deviation[2] = {0,0};
+	static UINT8 slot = 0;
+	
+	UINT8 i,j;
+	UINT8 type = 0;
+	UINT16 last;
+	UINT16 flux[2] = {0,0};
+	UINT16 average;
+	UINT16 spread;
+	UINT16 threshold;
+	UINT16 strength = 0;
+	UINT16 period;
+	
+	//The band levels only change every few ms, don't check them every loop
+	if (!Time_Check(&tmark,TEMPO_UPDATE_TIME))
+		return;
+	
+	//Record the levels so that the beat tracking can be tested on a PC
+	if (TEMPO_TRACE)
+		printf("T %lu %u %u %u %u %u %u %u\r\n",count32,level[0],level[1],level[2],
+		       level[3],level[4],level[5],level[6]);
+	
+	//The music has stopped, forget the tempo
+	if ((count32 - beat_time) > (TEMPO_MAX_PERIOD * 4))
+		beat_bpm = 0;
 	
-		//Find the value between the max and min thresholds
-		diff = max[i] - min[i];
+	//Add up how much each band has risen above its last readings
+	for (i = 0;i < 7;i++)
+	{
+		last = 0;
+		
+		for (j = 0;j < TEMPO_LAG;j++)
+		{
+			if (history[j][i] > last)
+				last = history[j][i];
+		}
+		
+		if (level[i] > last)
+		{
+			if (i < 2)
+				flux[0] += level[i] - last;
+			else if ((i >= 3) && (i <= 5))
+				flux[1] += level[i] - last;
+		}		
 		
-		//Calculate out the ADC value per step (By default there are 32 steps calculated)
-		step = (float)diff / VU_STEPS;
+		history[slot][i] = level[i];
+	}
+	
+	if (++slot >= TEMPO_LAG)
+		slot = 0;
+	
+	//Check the kicks and snares against their thresholds. 'mean' and 'deviation'
+	//are kept at 2^TEMPO_AVG_SHIFT times their value so no precision is lost.
+	for (i = 0;i < 2;i++)
+	{
+		average = mean[i] >> TEMPO_AVG_SHIFT;
+		spread = deviation[i] >> TEMPO_AVG_SHIFT;
 		
-		//Get the amount of real data read from the ADC (Subtract off the min values)
-		raw_value = chan[i] - min[i];
+		threshold = average + ((spread * TEMPO_SENSITIVITY) >> 2);
 		
-		//Calculate where the sound intesity falls between the allowed amount of steps (*VU_STEPS*)
-		level[i] = raw_value / step;
+		if (threshold < TEMPO_MIN_FLUX)
+			threshold = TEMPO_MIN_FLUX;
 		
-		//Peak Hold each value; Instead of quickly switching between highs and lows, allow the value 
-		//to decrease steadily, providing smooth transitions
-		if (PEAK_HOLD)
+		if ((flux[i] > threshold) && ((count32 - hit_mark[i]) >= TEMPO_REFRACTORY))
 		{
-			//If the new value is less than the previous one, decrease the intensity by the amount of
-			//steps that 'PEAK_LEVEL' is set to
-			if (level[i] < last_level[i] && last_level[i] >= PEAK_LEVEL)
-				level[i] = last_level[i] - PEAK_LEVEL;   
-		}	
-		
-		//Save the current reading for the next loop through
-		last_level[i] = level[i];	  
+			hit_mark[i] = count32;
+			type |= (i == 0) ? BEAT_KICK : BEAT_SNARE;
+			
+			if ((flux[i] - threshold) > strength)
+				strength = flux[i] - threshold;
+		}
+		
+		mean[i] += flux[i] - average;
+		
+		if (flux[i] > average)
+			deviation[i] += (flux[i] - average) - spread;
+		else
+			deviation[i] += (average - flux[i]) - spread;
 	}
-}	
+	
+	if (!type)
+		return;
+	
+	//Publish the beat
+	beat_type = type;
+	beat_strength = (strength > 255) ? 255 : strength;
+	beat_time = count32;
+	beat_count++;
+	
+	period = MSGEQ7_Tempo_Update(count32);
+	
+	if (period)
+		beat_bpm = 60000UL / period;
+	else
+		beat_bpm = 0;
+	
+	//Pass the beats that fall on the tempo to the animation clock
+	if (period && ((count32 - beat_mark) >= (((UINT32) period * 2) / 3)))
+	{
+		beat_mark = count32;
+		anim_period = period;
+		anim_beat = 1;
+	}
+}
+
+/*******************************************************************************
+* Function: MSGEQ7_Tempo_Update(UINT32 time)
+*
+* Variables:
+* time -> The time of the new onset (count32)
+*
+* Description:
+* This function adds the times between a new onset and the last TEMPO_ONSETS
+* onsets to the tempo histogram, and returns the tempo as a beat period in ms
+* (0 if no tempo is strong enough yet). Each time is folded into the tempo
+* range, so the gaps between a kick and a snare or across several beats all add
+* to the same tempo. The histogram fades with each onset and is cleared after a
+* long gap with no onsets. If the music also has a tempo twice as fast as the
+* strongest one, the faster one is returned.
+*******************************************************************************/
+UINT16 MSGEQ7_Tempo_Update(UINT32 time)
+{
+	static UINT32 onset[TEMPO_ONSETS];
+	static UINT16 histogram[TEMPO_BINS];
+	static UINT8 next = 0;
+	
+	UINT8 i;
+	UINT8 bin;
+	UINT8 best = 0;
+	UINT8 shift = 0;
+	UINT32 interval;
+	UINT32 strength[2];
+	UINT32 sum = 0;
+	UINT32 weight;
+	
+	//Start over after a long gap, otherwise let the old onsets fade away
+	interval = time - onset[(next + TEMPO_ONSETS - 1) % TEMPO_ONSETS];
+	
+	for (i = 0;i < TEMPO_BINS;i++)
+	{
+		if (interval > (TEMPO_MAX_PERIOD * 4))
+			histogram[i] = 0;
+		else
+			histogram[i] -= histogram[i] >> 3;
+	}
+		
+	//Add the time from each of the last onsets. The most recent ones count the
+	//most, so the real tempo wins over its multiples.
+	for (i = 0;i < TEMPO_ONSETS;i++)
+	{
+		interval = time - onset[(next + TEMPO_ONSETS - 1 - i) % TEMPO_ONSETS];
+		
+		if ((interval > (TEMPO_MAX_PERIOD * 2)) || (interval < (TEMPO_MIN_PERIOD / 2)))
+			continue;
+		
+		if (interval > (TEMPO_MAX_PERIOD + TEMPO_EDGE))
+			interval >>= 1;
+		else if (interval > TEMPO_MAX_PERIOD)
+			interval = TEMPO_MAX_PERIOD;
+		else if (interval < (TEMPO_MIN_PERIOD - TEMPO_EDGE))
+			interval <<= 1;
+		else if (interval < TEMPO_MIN_PERIOD)
+			interval = TEMPO_MIN_PERIOD;
+		
+		bin = (interval - TEMPO_MIN_PERIOD + (TEMPO_BIN / 2)) / TEMPO_BIN;
+		weight = (TEMPO_ONSETS - i) << 1;
+		
+		histogram[bin] += weight << 1;
+		
+		if (bin > 0)
+			histogram[bin - 1] += weight;
+		
+		if (bin < (TEMPO_BINS - 1))
+			histogram[bin + 1] += weight;
+	}
+	
+	onset[next] = time;
+	next = (next + 1) % TEMPO_ONSETS;
+	
+	//Find the strongest tempo
+	for (i = 1;i < TEMPO_BINS;i++)
+	{
+		if (histogram[i] > histogram[best])
+			best = i;
+	}
+	
+	if (histogram[best] < TEMPO_LOCK)
+		return 0;
+	
+	//The tempo range is wider than an octave, so the gaps across two beats add
+	//to half the tempo as well. If the music has a tempo twice as fast that is
+	//at least half as strong (with the bins on either side), that is the real 
+	//one. Its period is still found from the slower tempo, which is more precise.
+	interval = (TEMPO_MIN_PERIOD + (UINT16) best * TEMPO_BIN) >> 1;
+	
+	if (interval >= TEMPO_MIN_PERIOD)
+	{
+		bin = (interval - TEMPO_MIN_PERIOD + (TEMPO_BIN / 2)) / TEMPO_BIN;
+		strength[0] = 0;
+		strength[1] = histogram[best - 1] + histogram[best];
+		
+		if (best < (TEMPO_BINS - 1))
+			strength[1] += histogram[best + 1];
+		
+		for (i = (bin > 0) ? (bin - 1) : 0;i <= (bin + 1);i++)
+			strength[0] += histogram[i];
+		
+		if (strength[0] >= (strength[1] >> 1))
+			shift = 1;
+	}
+	
+	//Average the best bin with its neighbours to get a finer period
+	weight = 0;
+	
+	for (i = (best > 0) ? (best - 1) : 0;(i <= (best + 1)) && (i < TEMPO_BINS);i++)
+	{
+		sum += (UINT32) histogram[i] * i;
+		weight += histogram[i];
+	}
+	
+	return (TEMPO_MIN_PERIOD + ((sum * TEMPO_BIN) + (weight / 2)) / weight) >> shift;
+}
+
+/*******************************************************************************
+* Function: MSGEQ7_Beat(UINT16 *cursor)
+*
+* Variables:
+* *cursor -> The last beat this caller has seen (start at 0)
+*
+* Description:
+* This function returns the type of a new beat (BEAT_KICK and/or BEAT_SNARE), or
+* 0 if there hasn't been one since the last call with this cursor. A beat that
+* is older than TEMPO_REFRACTORY ms is too late to show and is skipped. Each 
+* caller keeps its own cursor, so any of the VU modes can follow the beats.
+*******************************************************************************/
+UINT8 MSGEQ7_Beat(UINT16 *cursor)
+{
+	if (*cursor == beat_count)
+		return 0;
+	
+	*cursor = beat_count;
+	
+	if ((count32 - beat_time) > TEMPO_REFRACTORY)
+		return 0;
+	
+	return beat_type;
+}
   
 #endif
\ No newline at end of file
@@ -19,29 +19,100 @@
 #define MSG_RESET             PORTAbits.RA11
 #define MSG_IN                PORTBbits.RB1
 
-//These values add an offset for each channel; Used to filter out noise	
-//If you have any channels that are getting high values even with no sound,
-//raise the offset amount here
-#define CH0_OFFSET						50
-#define CH1_OFFSET						50
-#define CH2_OFFSET						80
-#define CH3_OFFSET						80
-#define CH4_OFFSET						80
-#define CH5_OFFSET						100
-#define CH6_OFFSET						100
+//Automatic gain control used by MSGEQ7_Auto_Adjust(). Times are in ms and are
+//the time an envelope takes to move most of the way (~63%) to a new value.
+//The top of each band follows its peaks (attack) and then falls back (release)
+//so that quiet music still fills the VU meters.
+#define AGC_ATTACK_TIME				5
+#define AGC_RELEASE_TIME			3000
+
+//The noise floor of each band falls quickly to the lowest readings and rises
+//slowly, but never above AGC_MAX_FLOOR (ADC counts)
+#define AGC_FLOOR_FALL_TIME		100
+#define AGC_FLOOR_RISE_TIME		10000
+#define AGC_MAX_FLOOR					150
+
+//While the top of a band is within AGC_SILENCE (ADC counts) of its floor, the
+//band is silent and the height of its noise is learned. Readings below the
+//floor + noise are masked off. The learned noise falls back over AGC_NOISE_TIME.
+#define AGC_SILENCE						60
+#define AGC_NOISE_TIME				5000
+
+//The smallest range (ADC counts) that is spread across the VU_STEPS
+#define AGC_MIN_RANGE					50
+
+//The envelopes are 16.16 fixed point values
+#define AGC_FRAC							16
 
 //This determines the resolution of the returned VU signals
 #define VU_STEPS							32
 
-//Enables peak hold for the VU Meter. 1 = Enable; 0 = Disable
-#define PEAK_HOLD							1
-#define PEAK_LEVEL						1
+//The levels are spread over the top VU_RANGE_DEFAULT dB of each band. Each VU
+//mode can set its own range with MSGEQ7_Set_Range().
+#define VU_RANGE_DEFAULT			36
+
+//These values boost each band (in 1/4 dB) before its level is found. Most music
+//has less energy in the higher bands, so they get a little help. If you have
+//any channels that look too quiet or too loud, change the weight here.
+#define CH0_WEIGHT						0
+#define CH1_WEIGHT						0
+#define CH2_WEIGHT						0
+#define CH3_WEIGHT						4
+#define CH4_WEIGHT						8
+#define CH5_WEIGHT						12
+#define CH6_WEIGHT						16
+
+//Beat tracking used by MSGEQ7_Tempo(). The bands are checked every
+//TEMPO_UPDATE_TIME ms, and the rise (flux) of each band is measured from the
+//highest of its last TEMPO_LAG readings, so a slow wobble isn't counted.
+#define TEMPO_UPDATE_TIME			10
+#define TEMPO_LAG							2
+
+//An onset is a flux above its running average + TEMPO_SENSITIVITY / 4 times its
+//running deviation, and at least TEMPO_MIN_FLUX. The averages are kept over
+//2^TEMPO_AVG_SHIFT checks (~320ms).
+#define TEMPO_AVG_SHIFT				5
+#define TEMPO_SENSITIVITY			6
+#define TEMPO_MIN_FLUX				6
+
+//Onsets of the same type closer than this (ms) are part of the same hit
+#define TEMPO_REFRACTORY			100
+
+//The time between onsets is folded into the TEMPO_MIN_PERIOD - TEMPO_MAX_PERIOD
+//range (200 - 60 BPM) and added to a histogram with TEMPO_BIN ms bins. A time
+//less than TEMPO_EDGE ms outside of the range is a beat at the edge of it that
+//came a little early or late, so it is not folded. The last TEMPO_ONSETS onsets
+//are kept.
+#define TEMPO_MIN_PERIOD			300
+#define TEMPO_MAX_PERIOD			1000
+#define TEMPO_EDGE						20
+#define TEMPO_BIN							10
+#define TEMPO_BINS						((TEMPO_MAX_PERIOD - TEMPO_MIN_PERIOD) / TEMPO_BIN + 1)
+#define TEMPO_ONSETS					8
+
+//The weight the best histogram bin needs before the tempo is used
+#define TEMPO_LOCK						48
+
+//Set to 1 to print the band levels that MSGEQ7_Tempo() checks as a trace
+//("T <count32> <level0> ... <level6>") that tools/test/tempo_test can play back
+#define TEMPO_TRACE						0
+
+//Beat types. Kicks are found in the 63Hz and 160Hz bands, snares (and claps)
+//in the 1kHz - 6.25kHz bands.
+#define BEAT_KICK							0x01
+#define BEAT_SNARE						0x02
 
 /*************************************************
 *              Function Prototypes               *
 *************************************************/
 void MSGEQ7_Init(void);
-void MSGEQ7_Read(UINT16 *channel);
+UINT32 MSGEQ7_Read(UINT16 *channel);
+void MSGEQ7_Acquire(void);
+UINT32 MSGEQ7_Follow(UINT32 env, UINT32 target, UINT16 dt, UINT16 time);
+void MSGEQ7_Set_Range(UINT8 range);
 void MSGEQ7_Auto_Adjust(UINT16 *chan, UINT16 *level);
+void MSGEQ7_Tempo(UINT16 *level);
+UINT16 MSGEQ7_Tempo_Update(UINT32 time);
+UINT8 MSGEQ7_Beat(UINT16 *cursor);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,170 @@
+/*******************************************************************************
+* Title: Pod_History.c
+* Version: 1.0
+* Author: robotros
+* Date: October 19, 2026
+*
+* Description:
+* This file keeps a run-length history of the RGB pod sensors. Instead of saving
+* the state of every pod at every sensor update, only the intervals where a pod
+* stayed in one state are saved: which pod, its state, when the interval started
+* and how long it lasted. The intervals are built from the sensor change events
+* (IR_Event_Read()), so no extra scans of the sensors are needed. When a pod
+* changes state, the interval it was in is closed and written into a ring buffer
+* of HISTORY_SIZE intervals, which always holds the most recent ones.
+*
+* The history is sent over Bluetooth (Pod_History_Print()) and the client works
+* out the statistics from it (cups per minute, time between hits, reracks, etc.).
+*******************************************************************************/
+
+#ifndef POD_HISTORY_C
+#define POD_HISTORY_C
+
+#include "Main_Includes.h"
+#include "IR_Sensors.h"
+#include "Pod_History.h"
+#include "Delay_Setup.h"
+#include <stdio.h>
+
+/*************************************************
+*               Global Variables                 *
+*************************************************/
+extern volatile UINT32 count32;
+
+//Ring buffer of closed intervals. history_head is where the next one is written
+//and history_count is how many are in the buffer. history_since is the time
+//that the history is complete from (the end of the last interval that was 
+//overwritten, or when the history started).
+POD_INTERVAL history[HISTORY_SIZE];
+UINT16 history_head = 0;
+UINT16 history_count = 0;
+UINT32 history_since = 0;
+
+//The state of each pod and when it started (the interval that is still open)
+UINT8 history_state[HISTORY_PODS];
+UINT32 history_start[HISTORY_PODS];
+
+//Set once the history has started (see HISTORY_SETTLE)
+UINT8 history_ready = 0;
+
+/*******************************************************************************
+* Function: Pod_History_Update(void)
+*
+* Variables:
+* N/A
+*
+* Description:
+* This function reads any new sensor change events and closes the interval of
+* each pod that changed. It should be called after Update_All_Sensors(). Until
+* the sensors have settled, the events are skipped and the first interval of 
+* each pod starts in the state that it settled in.
+*******************************************************************************/
+void Pod_History_Update(void)
+{
+  static UINT16 events = 0;
+  static UINT32 settle = 0;
+  IR_EVENT event;
+  UINT32 now,length,state;
+  UINT8 i;
+
+  if (!history_ready)
+  {
+    IR_Event_Drain(&events);
+    
+    //Wait for the calibration to finish, then for the sensors to settle
+    if (IR_Calibration_Status() < 100)
+      settle = count32;
+      
+    if ((count32 - settle) < HISTORY_SETTLE)
+      return;
+      
+    state = IR_Reported();
+    now = count32 / HISTORY_TICK;
+    
+    for (i = 0;i < HISTORY_PODS;i++)
+    {
+      history_state[i] = (state >> i) & 0x01;
+      history_start[i] = now;
+    }
+    
+    history_since = now;
+    history_ready = 1;
+    
+    return;
+  }
+
+  while (IR_Event_Read(&events,&event))
+  {
+    if ((event.sensor >= HISTORY_PODS) || (event.state == history_state[event.sensor]))
+      continue;
+
+    now = event.time / HISTORY_TICK;
+    length = now - history_start[event.sensor];
+
+    //The oldest interval is about to be overwritten, the history is now only
+    //complete from the end of it
+    if (history_count == HISTORY_SIZE)
+      history_since = (UINT32) history[history_head].start + history[history_head].length;
+
+    history[history_head].start = history_start[event.sensor];
+    history[history_head].length = (length > 0xFFFF) ? 0xFFFF : length;
+    history[history_head].pod = event.sensor + 1;
+    history[history_head].state = history_state[event.sensor];
+
+    history_head = (history_head + 1) & (HISTORY_SIZE - 1);
+
+    if (history_count < HISTORY_SIZE)
+      history_count++;
+
+    //Start the next interval
+    history_state[event.sensor] = event.state;
+    history_start[event.sensor] = now;
+  }
+}
+
+/*******************************************************************************
+* Function: Pod_History_Print(void)
+*
+* Variables:
+* N/A
+*
+* Description:
+* This function sends the history out the UART (Bluetooth), oldest interval
+* first, as "Pod,State,Start,Length" lines. It ends with the interval that each
+* pod is still in, the time that the history is complete from (anything older
+* has been overwritten) and the current time, all in HISTORY_TICK ms units.
+*******************************************************************************/
+void Pod_History_Print(void)
+{
+  UINT8 i;
+  UINT16 n,slot;
+  UINT32 now,length;
+
+  Pod_History_Update();
+
+  now = count32 / HISTORY_TICK;
+
+  printf("Pod,State,Start,Length\r\n");
+
+  for (n = 0;n < history_count;n++)
+  {
+    slot = (history_head - history_count + n) & (HISTORY_SIZE - 1);
+
+    printf("%u,%u,%u,%u\r\n",history[slot].pod,history[slot].state,history[slot].start,history[slot].length);
+    Delay_ms(1);
+  }
+
+  //The intervals that are still open (none until the history has started)
+  for (i = 0;history_ready && (i < HISTORY_PODS);i++)
+  {
+    length = now - history_start[i];
+
+    printf("%u,%u,%u,%u\r\n",i + 1,history_state[i],(UINT16) history_start[i],(length > 0xFFFF) ? 0xFFFF : (UINT16) length);
+    Delay_ms(1);
+  }
+
+  printf("Since,%u\r\n",(UINT16) history_since);
+  printf("Now,%u\r\n",(UINT16) now);
+}
+
+#endif
@@ -0,0 +1,54 @@
+/*******************************************************************************
+* Title: Pod_History.h
+* Version: 1.0
+* Author: robotros
+* Date: October 19, 2026
+*
+* Description:
+* This file contains the definitions and function prototypes for the history of
+* the RGB pod sensors. The history keeps how long each pod has had a cup on it
+* (or not) so that game statistics can be worked out over Bluetooth.
+*******************************************************************************/
+
+#ifndef POD_HISTORY_H
+#define POD_HISTORY_H
+
+/*************************************************
+*                   Constants                    *
+*************************************************/
+//The amount of pods that are tracked (the ball washer sensors are not)
+#define HISTORY_PODS          20
+
+//The amount of intervals that are kept (must be a power of 2). Each one takes 6
+//bytes. A busy game changes a cup every few seconds, so this covers more than
+//the last 10 minutes of play, but a flapping sensor can change up to 
+//IR_FLIP_LIMIT times in each health window before it is masked off and there 
+//isn't the RAM for that worst case. Pod_History_Print() sends the time that the
+//history is complete from instead.
+#define HISTORY_SIZE          256
+
+//The history starts once the sensors have been calibrated and then debounced
+//for HISTORY_SETTLE ms, so that the cups already on the table are not recorded
+//as being added at power up
+#define HISTORY_SETTLE        500
+
+//Interval times are in units of HISTORY_TICK ms. The 16-bit start times wrap
+//around every ~109 minutes and longer intervals are limited to 0xFFFF.
+#define HISTORY_TICK          100
+
+//One interval where a pod stayed in the same state (0 = no cup, 1 = cup)
+typedef struct
+{
+  UINT16 start;
+  UINT16 length;
+  UINT8 pod;
+  UINT8 state;
+} POD_INTERVAL;
+
+/*************************************************
+*              Function Prototypes               *
+*************************************************/
+void Pod_History_Update(void);
+void Pod_History_Print(void);
+
+#endif
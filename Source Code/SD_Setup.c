@@ -341,19 +341,20 @@ UINT8 SD_Read_Sector(UINT32 sector, UINT8 *buf)
 } 
         
 /*******************************************************************************
-* Function: SD_Read_Mul_Sectors(UINT32 start, UINT32 amount)                                                                   
+* Function: SD_Read_Mul_Sectors(UINT32 start, UINT32 amount, UINT8 *buf)                                                                   
 *                                                                              
 * Variables:                                                                   
 * start -> Address of first sector to be read
 * amount -> The amount of consecutive sectors to be read                                                                         
+* *buf -> The buffer where the data will be stored (amount * 512 bytes)
 *                                                                              
 * Description:                                                                 
 * This function will read the specified amount of sectors starting from the                                                                             
-* address of the 'start' variable. If this function is to be used with a small
-* buffer, the user will have to add code to parse the received data before 
-* overwriting it with new data from the next sector(s).                                                                              
+* address of the 'start' variable with one multiple block read (CMD18). The
+* sectors are stored one after another in the buffer, so it must be large
+* enough to hold all of them.                                                                              
 *******************************************************************************/
-UINT8 SD_Read_Mul_Sectors(UINT32 start, UINT32 amount)
+UINT8 SD_Read_Mul_Sectors(UINT32 start, UINT32 amount, UINT8 *buf)
 {
   static UINT8 CMD12[SD_CMD_LEN] = {SD_CMD12,0x00,0x00,0x00,0x00,0xFF};
   static UINT8 CMD18[SD_CMD_LEN] = {SD_CMD18,0x00,0x00,0x00,0x00,0xFF};
@@ -389,22 +390,20 @@ UINT8 SD_Read_Mul_Sectors(UINT32 start, UINT32 amount)
     //Ensure that a read token is received from SD card before filling buffer
     if (SD_Match(0xFE)) 
     {
-      //No read token was received, return error
+      //No read token was received, stop the read and return error
+      SD_Command(CMD12,SD_CMD_LEN);
+      SPI_SD_SEND(0xFF);
+      SD_DISABLE();
       return SD_READ_ERROR;
     }
    
-    //Store sector data in first 512 bytes of SD_buf[SD_BUF_SIZE]
+    //Store sector data in the next 512 bytes of the buffer
     for (i = 0;i < SD_SECTOR_SIZE;i++)
-      SD_buf[i+(j*SD_SECTOR_SIZE)] = SPI_SD_SEND(0xFF);
+      *buf++ = SPI_SD_SEND(0xFF);
     
     //Send two dummy CRC bytes
     SPI_SD_SEND(0xFF);
     SPI_SD_SEND(0xFF);         
-    
-    /***************************************************
-    * Add code to parse sector data here or modify code to fill
-    * up a large enough buffer (if you have enough RAM)
-    ****************************************************/
   }
   
   //Send stop token to cease read operation
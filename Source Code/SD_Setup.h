@@ -106,7 +106,7 @@ UINT8 SD_Command(UINT8 *data, UINT16 len);
 UINT8 SD_Read_Sector(UINT32 sector, UINT8 *buf);
 UINT8 SD_Write_Sector(UINT32 sector, UINT8 *buf);
 UINT8 SD_Erase_Sectors(UINT32 start, UINT32 amount);
-UINT8 SD_Read_Mul_Sectors(UINT32 start, UINT32 amount);
+UINT8 SD_Read_Mul_Sectors(UINT32 start, UINT32 amount, UINT8 *buf);
 UINT8 SD_Write_Mul_Sectors(UINT32 start, UINT32 amount);
 
 UINT32 SD_Capacity(void);
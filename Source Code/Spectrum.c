@@ -0,0 +1,365 @@
+/*******************************************************************************
+* Title: Spectrum.c
+* Version: 1.0
+* Author: robotros
+* Date: October 19, 2026
+*
+* Description:
+* This file contains the software spectrum analyzer. The MSGEQ7 only gives 7
+* bands, which is not enough to fill the 32 columns of the LED grid, so this
+* takes the audio samples straight from the ADC and runs its own FFT.
+*
+* DMA channel 0 copies every conversion of the audio input into two buffers of
+* SPECTRUM_N samples, filling one while the other holds the last full frame
+* (ping-pong), so the interrupts can never leave a gap in a frame. Every
+* SPECTRUM_FRAME_TIME ms, Spectrum_Update() (main loop) takes the last full
+* frame, removes the DC offset, applies a Hann window
+* (Spectrum_Window()) and runs a radix-2 FFT in Q15 fixed point (Spectrum_FFT()).
+* Each stage of the FFT halves its output so nothing can overflow. The bins are
+* then grouped into SPECTRUM_COLUMNS bars (Spectrum_Bin()) and the height of each
+* bar is the log of its loudest bin, so each pixel is ~3dB. The bars are not log
+* spaced: there are only 63 bins of 125Hz, so the first 26 bars are one bin each
+* (125Hz - 3.25kHz) and only the top 6 bars get wider (see spectrum_edge[]).
+*
+* Only Spectrum_Init() and Spectrum_Update() use the DMA, the rest can be tested
+* on a PC with tools/test/spectrum_test.
+*******************************************************************************/
+
+#ifndef SPECTRUM_C
+#define SPECTRUM_C
+
+#include "Main_Includes.h"
+#include "Delay_Setup.h"
+#include "Grid_Setup.h"
+#include "Spectrum.h"
+
+/*************************************************
+*               Global Variables                 *
+*************************************************/
+extern volatile UINT32 count32;
+
+//The DMA fills one of these while the other holds the last full frame
+volatile INT16 spectrum_dma[2][SPECTRUM_N];
+
+//The last full frame is copied into 'spectrum_re' and the FFT is run in place
+INT16 spectrum_re[SPECTRUM_N];
+INT16 spectrum_im[SPECTRUM_N];
+
+//sin(2*pi*k / SPECTRUM_N) for k = 0 - 95 in Q15. cos(x) = spectrum_sin[k + 32].
+const INT16 spectrum_sin[(SPECTRUM_N * 3) / 4] =
+{
+  0,1608,3212,4808,6393,7962,9512,11039,12539,14010,15446,16846,
+  18204,19519,20787,22005,23170,24279,25329,26319,27245,28105,28898,29621,
+  30273,30852,31356,31785,32137,32412,32609,32728,32767,32728,32609,32412,
+  32137,31785,31356,30852,30273,29621,28898,28105,27245,26319,25329,24279,
+  23170,22005,20787,19519,18204,16846,15446,14010,12539,11039,9512,7962,
+  6393,4808,3212,1608,0,-1608,-3212,-4808,-6393,-7962,-9512,-11039,
+  -12539,-14010,-15446,-16846,-18204,-19519,-20787,-22005,-23170,-24279,-25329,-26319,
+  -27245,-28105,-28898,-29621,-30273,-30852,-31356,-31785,-32137,-32412,-32609,-32728
+};
+
+//The first half of a SPECTRUM_N point Hann window in Q15 (the window is symmetric)
+const INT16 spectrum_window[SPECTRUM_N / 2] =
+{
+  0,20,80,180,320,499,717,973,1267,1597,1965,2367,
+  2803,3273,3775,4308,4870,5461,6078,6721,7387,8075,8784,9511,
+  10254,11013,11785,12569,13361,14161,14967,15776,16586,17396,18203,19006,
+  19803,20591,21369,22135,22886,23622,24340,25039,25716,26371,27001,27605,
+  28181,28729,29247,29733,30186,30606,30990,31340,31652,31927,32164,32363,
+  32522,32642,32722,32762
+};
+
+//The first FFT bin of each bar (the last entry is the end of the last bar).
+//A log scale would need less than one bin per bar below ~3kHz, so the bars are
+//one bin (125Hz) wide up to 3.25kHz and only the top 6 bars widen towards 8kHz.
+const UINT8 spectrum_edge[SPECTRUM_COLUMNS + 1] =
+{
+  1,2,3,4,5,6,7,8,9,10,11,12,13,14,15,16,
+  17,18,19,20,21,22,23,24,25,26,29,33,38,43,49,55,64
+};
+
+/*******************************************************************************
+* Function: Spectrum_Init(void)
+*
+* Variables:
+* N/A
+*
+* Description:
+* This function sets up DMA channel 0 to copy every conversion of the audio
+* input (SPECTRUM_INPUT) into 'spectrum_dma[2]', switching buffers every
+* SPECTRUM_N samples. The ADC must already be converting in the background (see
+* ADC_Start_Triggered()). The DMA interrupt is not used, Spectrum_Update() polls
+* its flag.
+*******************************************************************************/
+void Spectrum_Init(void)
+{
+  DMA0CONbits.CHEN = 0;
+
+  //Word transfers from the peripheral to RAM, post-increment, continuous with
+  //ping-pong buffers
+  DMA0CON = 0x0002;
+  DMA0REQ = SPECTRUM_DMA_IRQ;
+  DMA0PAD = (UINT16) &SPECTRUM_INPUT;
+  DMA0STAL = (UINT16) spectrum_dma[0];
+  DMA0STAH = 0;
+  DMA0STBL = (UINT16) spectrum_dma[1];
+  DMA0STBH = 0;
+  DMA0CNT = SPECTRUM_N - 1;
+
+  _DMA0IF = 0;
+  _DMA0IE = 0;
+
+  DMA0CONbits.CHEN = 1;
+}
+
+/*******************************************************************************
+* Function: Spectrum_Window(INT16 *re, INT16 *im)
+*
+* Variables:
+* *re -> The SPECTRUM_N 10-bit samples, replaced with the windowed samples (Q15)
+* *im -> The imaginary part of the samples, cleared to 0
+*
+* Description:
+* This function removes the DC offset from the samples, scales them up to Q15
+* (+/-512 -> +/-16384) and applies the Hann window, ready for Spectrum_FFT().
+*******************************************************************************/
+void Spectrum_Window(INT16 *re, INT16 *im)
+{
+  UINT8 i,x;
+  INT32 sum = 0;
+  INT16 offset;
+
+  for (i = 0;i < SPECTRUM_N;i++)
+    sum += re[i];
+
+  offset = sum >> SPECTRUM_LOG2N;
+
+  for (i = 0;i < SPECTRUM_N;i++)
+  {
+    x = (i < (SPECTRUM_N / 2)) ? i : (SPECTRUM_N - 1 - i);
+
+    re[i] = ((INT32) ((re[i] - offset) << 5) * spectrum_window[x]) >> 15;
+    im[i] = 0;
+  }
+}
+
+/*******************************************************************************
+* Function: Spectrum_FFT(INT16 *re, INT16 *im)
+*
+* Variables:
+* *re -> The real part of the SPECTRUM_N samples (Q15), replaced with the result
+* *im -> The imaginary part of the samples (Q15), replaced with the result
+*
+* Description:
+* This function runs a radix-2 decimation in time FFT in place. Every stage
+* divides its output by 2, so the result is the FFT divided by SPECTRUM_N and it
+* can never overflow. The 16 x 16 bit multiplies compile to single cycle MUL.SS
+* instructions.
+*******************************************************************************/
+void Spectrum_FFT(INT16 *re, INT16 *im)
+{
+  UINT8 i,j,k;
+  UINT8 bit;
+  UINT8 half;
+  UINT8 step;
+  UINT8 start;
+  UINT16 size;
+  INT16 c,s;
+  INT16 temp;
+  INT32 tr,ti;
+
+  //Put the samples in bit reversed order
+  for (i = 1,j = 0;i < SPECTRUM_N;i++)
+  {
+    bit = SPECTRUM_N >> 1;
+
+    while (j & bit)
+    {
+      j ^= bit;
+      bit >>= 1;
+    }
+
+    j |= bit;
+
+    if (i < j)
+    {
+      temp = re[i];
+      re[i] = re[j];
+      re[j] = temp;
+
+      temp = im[i];
+      im[i] = im[j];
+      im[j] = temp;
+    }
+  }
+
+  //Combine the butterflies, doubling their size each stage
+  for (size = 2;size <= SPECTRUM_N;size <<= 1)
+  {
+    half = size >> 1;
+    step = SPECTRUM_N / size;
+
+    for (k = 0;k < half;k++)
+    {
+      //The twiddle factor is cos(x) - j sin(x), x = 2*pi*k / size
+      c = spectrum_sin[(k * step) + (SPECTRUM_N / 4)];
+      s = spectrum_sin[k * step];
+
+      for (start = 0;start < SPECTRUM_N;start += size)
+      {
+        i = start + k;
+        j = i + half;
+
+        tr = ((INT32) re[j] * c + (INT32) im[j] * s) >> 15;
+        ti = ((INT32) im[j] * c - (INT32) re[j] * s) >> 15;
+
+        re[j] = ((INT32) re[i] - tr) >> 1;
+        im[j] = ((INT32) im[i] - ti) >> 1;
+        re[i] = ((INT32) re[i] + tr) >> 1;
+        im[i] = ((INT32) im[i] + ti) >> 1;
+      }
+    }
+  }
+}
+
+/*******************************************************************************
+* Function: Spectrum_Log(UINT16 value)
+*
+* Variables:
+* value -> The value to convert
+*
+* Description:
+* This function returns 2 * log2(value), rounded down to a half power of 2, so
+* each step is ~3dB. 0 and 1 both return 0.
+*******************************************************************************/
+UINT8 Spectrum_Log(UINT16 value)
+{
+  UINT8 bit = 0;
+
+  if (value < 2)
+    return 0;
+
+  while (value >> (bit + 1))
+    bit++;
+
+  //Add a half step if the bit below the highest one is set
+  return (bit << 1) + ((value >> (bit - 1)) & 1);
+}
+
+/*******************************************************************************
+* Function: Spectrum_Bin(INT16 *re, INT16 *im, UINT8 *level)
+*
+* Variables:
+* *re -> The real part of the result of Spectrum_FFT()
+* *im -> The imaginary part of the result of Spectrum_FFT()
+* *level -> Stores the level of each of the SPECTRUM_COLUMNS bars (0 - GRID_Y_MAX)
+*
+* Description:
+* This function groups the FFT bins into bars (see spectrum_edge[]). The level
+* of each bar is the log of its loudest bin (~3dB per pixel), less SPECTRUM_FLOOR.
+*******************************************************************************/
+void Spectrum_Bin(INT16 *re, INT16 *im, UINT8 *level)
+{
+  UINT8 i,x;
+  UINT8 bar;
+  UINT16 a,b;
+  UINT16 peak;
+  UINT16 magnitude;
+
+  for (x = 0;x < SPECTRUM_COLUMNS;x++)
+  {
+    //Find the loudest bin of the bar. The magnitude is max + 3/8 min, which is
+    //within ~7% of the real value.
+    peak = 0;
+
+    for (i = spectrum_edge[x];i < spectrum_edge[x+1];i++)
+    {
+      a = (re[i] < 0) ? -re[i] : re[i];
+      b = (im[i] < 0) ? -im[i] : im[i];
+
+      if (a > b)
+        magnitude = a + (b >> 2) + (b >> 3);
+      else
+        magnitude = b + (a >> 2) + (a >> 3);
+
+      if (magnitude > peak)
+        peak = magnitude;
+    }
+
+    bar = Spectrum_Log(peak);
+    bar = (bar > SPECTRUM_FLOOR) ? (bar - SPECTRUM_FLOOR) : 0;
+
+    if (bar > GRID_Y_MAX)
+      bar = GRID_Y_MAX;
+
+    level[x] = bar;
+  }
+}
+
+/*******************************************************************************
+* Function: Spectrum_Update(UINT8 *height)
+*
+* Variables:
+* *height -> The height of each of the SPECTRUM_COLUMNS bars (0 - GRID_Y_MAX)
+*
+* Description:
+* Every SPECTRUM_FRAME_TIME ms, once the DMA has filled a buffer, this function
+* takes the last full frame and works out the new bar heights. A bar jumps
+* straight up to a louder level and falls by one pixel every SPECTRUM_FALL_TIME
+* ms, however often this is called. Returns a 1 when the bars have changed,
+* otherwise a 0.
+*******************************************************************************/
+UINT8 Spectrum_Update(UINT8 *height)
+{
+  static UINT32 tmark = 0;
+  static UINT32 fall_mark = 0;
+
+  UINT8 i,x;
+  UINT8 full;
+  UINT8 fall;
+  UINT8 level[SPECTRUM_COLUMNS];
+
+  //Wait for the next frame and for the DMA to fill a buffer
+  if (((count32 - tmark) < SPECTRUM_FRAME_TIME) || !_DMA0IF)
+    return 0;
+
+  _DMA0IF = 0;
+
+  //The DMA is filling one buffer, the other one holds the last full frame
+  full = DMAPPSbits.PPST0 ? 0 : 1;
+
+  for (i = 0;i < SPECTRUM_N;i++)
+    spectrum_re[i] = spectrum_dma[full][i];
+
+  //If the DMA filled another buffer in the meantime, it has started writing
+  //over this frame. Skip it, the next call takes the new one.
+  if (_DMA0IF)
+    return 0;
+
+  tmark = count32;
+
+  Spectrum_Window(spectrum_re,spectrum_im);
+  Spectrum_FFT(spectrum_re,spectrum_im);
+  Spectrum_Bin(spectrum_re,spectrum_im,level);
+
+  //Find how many pixels the bars have fallen since the last frame
+  fall = (count32 - fall_mark) / SPECTRUM_FALL_TIME;
+
+  if (fall)
+    fall_mark += (UINT32) fall * SPECTRUM_FALL_TIME;
+
+  for (x = 0;x < SPECTRUM_COLUMNS;x++)
+  {
+    //Jump up to a louder level, otherwise fall slowly
+    if (level[x] >= height[x])
+      height[x] = level[x];
+    else if ((height[x] - level[x]) > fall)
+      height[x] -= fall;
+    else
+      height[x] = level[x];
+  }
+
+  return 1;
+}
+
+#endif
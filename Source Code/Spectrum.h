@@ -0,0 +1,61 @@
+/*******************************************************************************
+* Title: Spectrum.h
+* Version: 1.0
+* Author: robotros
+* Date: October 19, 2026
+*
+* Description:
+* This file contains the definitions and function prototypes for the software
+* spectrum analyzer. It samples the audio with the ADC, runs a fixed point FFT
+* on it and splits the result into one bar for each of the 32 grid columns.
+*******************************************************************************/
+
+#ifndef SPECTRUM_H
+#define SPECTRUM_H
+
+/*************************************************
+*                   Constants                    *
+*************************************************/
+//Set to 1 to allow the spectrum analyzer (VU mode 5). It needs the line level
+//audio (AC coupled and biased to half of AVdd) on the input that SPECTRUM_INPUT
+//reads. The stock board only has the MSGEQ7 output on that pin (AN3), so it is
+//off by default.
+#define SPECTRUM_ENABLE       0
+#define SPECTRUM_INPUT        ADC1BUF0
+
+//The amount of samples in each FFT (SPECTRUM_N = 2^SPECTRUM_LOG2N). The samples
+//are the background conversions of the ADC, one every 250us / ADC_OVERSAMPLE
+//(16kHz), so each FFT bin is 125Hz wide and the top bin is 8kHz.
+#define SPECTRUM_N            128
+#define SPECTRUM_LOG2N        7
+
+//The samples are copied from SPECTRUM_INPUT by DMA channel 0. Every ADC
+//conversion requests a transfer (IRQ 13, ADC1 convert done).
+#define SPECTRUM_DMA_IRQ      13
+
+//The amount of bars (one for each grid column)
+#define SPECTRUM_COLUMNS      32
+
+//The time between frames in ms (~60 frames per second)
+#define SPECTRUM_FRAME_TIME   16
+
+//Each pixel of a bar is half of a power of 2 (~3dB). The loudest bin of a sine
+//is ~8x its amplitude in ADC counts (Q15 scaling, the window and the FFT), so a
+//full scale sine (+/-512) is half step 24. SPECTRUM_FLOOR puts the top of the
+//grid 1 pixel below that, the bottom pixel is ~12 counts (-33dB).
+#define SPECTRUM_FLOOR        11
+
+//The time in ms for a bar to fall by one pixel
+#define SPECTRUM_FALL_TIME    40
+
+/*************************************************
+*              Function Prototypes               *
+*************************************************/
+void Spectrum_Init(void);
+void Spectrum_Window(INT16 *re, INT16 *im);
+void Spectrum_FFT(INT16 *re, INT16 *im);
+UINT8 Spectrum_Log(UINT16 value);
+void Spectrum_Bin(INT16 *re, INT16 *im, UINT8 *level);
+UINT8 Spectrum_Update(UINT8 *height);
+
+#endif
@@ -0,0 +1,373 @@
+/*******************************************************************************
+* Title: Table_Map.c
+* Version: 1.0
+* Author: robotros
+* Date: October 19, 2026
+*
+* Description:
+* This file contains the spatial map of the table. The position of each RGB pod,
+* LED ring and LED grid pixel is stored in flash, along with the distance from a
+* few common centers to each of them. Ripples and sweeps can then be done with
+* table lookups instead of listing the pods and rings by hand for each animation.
+*
+* Pods 1 - 10 form the MASTER SIDE pyramid, numbered from the front cup (1) to
+* the back row (7 - 10), which puts pod 5 in the middle of the pyramid. Pods 
+* 11 - 20 are the same on the SECONDARY SIDE and pod 21 is the underlighting.
+* LED rings 1 - 4 and 13 run along one side of the table, rings 5 - 8 and 14 
+* along the other and rings 9 - 12 are the ball washer rings in the corners. 
+* Rings 15 and 16 are not used by the stock animations and are placed at the 
+* ends of the table.
+*******************************************************************************/
+
+#ifndef TABLE_MAP_C
+#define TABLE_MAP_C
+
+#include "Main_Includes.h"
+#include "Grid_Setup.h"
+#include "LED_Control.h"
+#include "LED_Graphics.h"
+#include "Table_Map.h"
+
+/*************************************************
+*               Global Variables                 *
+*************************************************/
+extern volatile T16_FLAG FLAG1;
+
+extern volatile UINT32 grid_row[12];
+
+//The position of each RGB pod (1 - 21) on the table. Entry 0 is not used.
+const MAP_POINT pod_map[22] =
+{
+  {  0,  0},
+  { 46, 32},
+  { 34, 25},
+  { 34, 39},
+  { 22, 18},
+  { 22, 32},
+  { 22, 46},
+  { 10, 11},
+  { 10, 25},
+  { 10, 39},
+  { 10, 53},
+  {209, 32},
+  {221, 25},
+  {221, 39},
+  {233, 18},
+  {233, 32},
+  {233, 46},
+  {245, 11},
+  {245, 25},
+  {245, 39},
+  {245, 53},
+  {128, 32}
+};
+
+//The position of each LED ring (1 - 16) on the table. Entry 0 is not used.
+const MAP_POINT ring_map[17] =
+{
+  {  0,  0},
+  { 52,  2},
+  {100,  2},
+  {155,  2},
+  {203,  2},
+  { 52, 61},
+  {100, 61},
+  {155, 61},
+  {203, 61},
+  {  4,  2},
+  {  4, 61},
+  {251, 61},
+  {251,  2},
+  {128,  2},
+  {128, 61},
+  {  4, 32},
+  {251, 32}
+};
+
+//The distance from each center to each RGB pod. Entry 0 is not used.
+const UINT8 pod_distance[MAP_CENTERS][22] =
+{
+  //MAP_TABLE_CENTER
+  {0,41,47,47,53,53,53,60,59,59,60,40,47,47,53,52,53,59,59,59,59,0},
+  //MAP_PYRAMIDS
+  {0,12,7,7,7,0,7,12,7,7,12,12,7,7,7,0,7,12,7,7,12,52},
+  //MAP_MASTER_PYRAMID
+  {0,12,7,7,7,0,7,12,7,7,12,94,100,100,106,106,106,112,112,112,112,53},
+  //MAP_SECONDARY_PYRAMID
+  {0,94,100,100,106,106,106,112,112,112,112,12,7,7,7,0,7,12,7,7,12,52},
+  //MAP_MASTER_END
+  {0,23,17,17,11,11,11,5,5,5,5,104,110,110,116,116,116,122,122,122,122,64},
+  //MAP_SECONDARY_END
+  {0,104,110,110,116,116,116,122,122,122,122,23,17,17,11,11,11,5,5,5,5,64}
+};
+
+//The distance from each center to each LED ring. Entry 0 is not used.
+const UINT8 ring_distance[MAP_CENTERS][17] =
+{
+  //MAP_TABLE_CENTER
+  {0,41,21,20,40,41,20,20,40,64,64,63,63,15,14,62,62},
+  //MAP_PYRAMIDS
+  {0,21,42,42,21,21,42,42,21,17,17,17,17,55,54,9,9},
+  //MAP_MASTER_PYRAMID
+  {0,21,42,68,92,21,42,68,92,17,17,115,115,55,55,9,114},
+  //MAP_SECONDARY_PYRAMID
+  {0,92,68,42,21,92,68,42,21,115,115,17,17,55,54,114,9},
+  //MAP_MASTER_END
+  {0,26,50,78,102,26,50,78,102,2,2,126,126,64,64,2,126},
+  //MAP_SECONDARY_END
+  {0,102,78,50,26,102,78,50,26,126,126,2,2,64,64,126,2}
+};
+
+//Pods 1 - 20 sorted from the closest to the furthest pod from each center
+const UINT8 pod_order[MAP_CENTERS][20] =
+{
+  //MAP_TABLE_CENTER
+  {11,1,2,3,12,13,15,4,5,6,14,16,8,9,17,18,19,20,7,10},
+  //MAP_PYRAMIDS
+  {5,15,2,3,4,6,8,9,12,13,14,16,18,19,1,7,10,11,17,20},
+  //MAP_MASTER_PYRAMID
+  {5,2,3,4,6,8,9,1,7,10,11,12,13,14,15,16,17,18,19,20},
+  //MAP_SECONDARY_PYRAMID
+  {15,12,13,14,16,18,19,11,17,20,1,2,3,4,5,6,7,8,9,10},
+  //MAP_MASTER_END
+  {7,8,9,10,4,5,6,2,3,1,11,12,13,14,15,16,17,18,19,20},
+  //MAP_SECONDARY_END
+  {17,18,19,20,14,15,16,12,13,11,1,2,3,4,5,6,7,8,9,10}
+};
+
+//The furthest distance from each center to any pod, ring or grid pixel
+const UINT8 map_max_distance[MAP_CENTERS] = {64,55,115,115,126,126};
+
+//The distance from each center to each pixel of the LED grid, [center][y][x]
+const UINT8 grid_distance[MAP_CENTERS][GRID_Y_MAX][GRID_X_MAX] =
+{
+  //MAP_TABLE_CENTER
+  {
+    { 33, 31, 29, 27, 25, 24, 22, 20, 19, 17, 16, 14, 13, 12, 11, 11, 11, 11, 12, 13, 14, 16, 17, 19, 20, 22, 24, 25, 27, 29, 31, 33},
+    { 32, 30, 28, 27, 25, 23, 21, 19, 17, 16, 14, 13, 11, 10,  9,  9,  9,  9, 10, 11, 13, 14, 16, 17, 19, 21, 23, 25, 27, 28, 30, 32},
+    { 32, 30, 28, 26, 24, 22, 20, 18, 17, 15, 13, 11, 10,  9,  8,  7,  7,  8,  9, 10, 11, 13, 15, 17, 18, 20, 22, 24, 26, 28, 30, 32},
+    { 31, 29, 27, 25, 24, 22, 20, 18, 16, 14, 12, 10,  9,  7,  6,  5,  5,  6,  7,  9, 10, 12, 14, 16, 18, 20, 22, 24, 25, 27, 29, 31},
+    { 31, 29, 27, 25, 23, 21, 19, 17, 15, 13, 11,  9,  8,  6,  4,  3,  3,  4,  6,  8,  9, 11, 13, 15, 17, 19, 21, 23, 25, 27, 29, 31},
+    { 31, 29, 27, 25, 23, 21, 19, 17, 15, 13, 11,  9,  7,  5,  3,  1,  1,  3,  5,  7,  9, 11, 13, 15, 17, 19, 21, 23, 25, 27, 29, 31},
+    { 31, 29, 27, 25, 23, 21, 19, 17, 15, 13, 11,  9,  7,  5,  3,  1,  1,  3,  5,  7,  9, 11, 13, 15, 17, 19, 21, 23, 25, 27, 29, 31},
+    { 31, 29, 27, 25, 23, 21, 19, 17, 15, 13, 11,  9,  8,  6,  4,  3,  3,  4,  6,  8,  9, 11, 13, 15, 17, 19, 21, 23, 25, 27, 29, 31},
+    { 31, 29, 27, 25, 24, 22, 20, 18, 16, 14, 12, 10,  9,  7,  6,  5,  5,  6,  7,  9, 10, 12, 14, 16, 18, 20, 22, 24, 25, 27, 29, 31},
+    { 32, 30, 28, 26, 24, 22, 20, 18, 17, 15, 13, 11, 10,  9,  8,  7,  7,  8,  9, 10, 11, 13, 15, 17, 18, 20, 22, 24, 26, 28, 30, 32},
+    { 32, 30, 28, 27, 25, 23, 21, 19, 17, 16, 14, 13, 11, 10,  9,  9,  9,  9, 10, 11, 13, 14, 16, 17, 19, 21, 23, 25, 27, 28, 30, 32},
+    { 33, 31, 29, 27, 25, 24, 22, 20, 19, 17, 16, 14, 13, 12, 11, 11, 11, 11, 12, 13, 14, 16, 17, 19, 20, 22, 24, 25, 27, 29, 31, 33}
+  },
+  //MAP_PYRAMIDS
+  {
+    { 25, 26, 28, 30, 32, 34, 36, 38, 40, 41, 43, 45, 47, 49, 51, 53, 53, 51, 49, 47, 45, 43, 41, 39, 37, 35, 33, 31, 30, 28, 26, 24},
+    { 24, 26, 28, 29, 31, 33, 35, 37, 39, 41, 43, 45, 47, 49, 51, 53, 52, 50, 48, 46, 44, 42, 41, 39, 37, 35, 33, 31, 29, 27, 25, 23},
+    { 23, 25, 27, 29, 31, 33, 35, 37, 39, 41, 43, 45, 47, 49, 50, 52, 52, 50, 48, 46, 44, 42, 40, 38, 36, 34, 32, 30, 28, 26, 25, 23},
+    { 23, 25, 26, 28, 30, 32, 34, 36, 38, 40, 42, 44, 46, 48, 50, 52, 52, 50, 48, 46, 44, 42, 40, 38, 36, 34, 32, 30, 28, 26, 24, 22},
+    { 22, 24, 26, 28, 30, 32, 34, 36, 38, 40, 42, 44, 46, 48, 50, 52, 52, 50, 48, 46, 44, 42, 40, 38, 36, 34, 32, 30, 28, 26, 24, 22},
+    { 22, 24, 26, 28, 30, 32, 34, 36, 38, 40, 42, 44, 46, 48, 50, 52, 52, 50, 48, 46, 44, 42, 40, 38, 36, 34, 32, 30, 28, 26, 24, 22},
+    { 22, 24, 26, 28, 30, 32, 34, 36, 38, 40, 42, 44, 46, 48, 50, 52, 52, 50, 48, 46, 44, 42, 40, 38, 36, 34, 32, 30, 28, 26, 24, 22},
+    { 22, 24, 26, 28, 30, 32, 34, 36, 38, 40, 42, 44, 46, 48, 50, 52, 52, 50, 48, 46, 44, 42, 40, 38, 36, 34, 32, 30, 28, 26, 24, 22},
+    { 23, 25, 26, 28, 30, 32, 34, 36, 38, 40, 42, 44, 46, 48, 50, 52, 52, 50, 48, 46, 44, 42, 40, 38, 36, 34, 32, 30, 28, 26, 24, 22},
+    { 23, 25, 27, 29, 31, 33, 35, 37, 39, 41, 43, 45, 47, 49, 50, 52, 52, 50, 48, 46, 44, 42, 40, 38, 36, 34, 32, 30, 28, 26, 25, 23},
+    { 24, 26, 28, 29, 31, 33, 35, 37, 39, 41, 43, 45, 47, 49, 51, 53, 52, 50, 48, 46, 44, 42, 41, 39, 37, 35, 33, 31, 29, 27, 25, 23},
+    { 25, 26, 28, 30, 32, 34, 36, 38, 40, 41, 43, 45, 47, 49, 51, 53, 53, 51, 49, 47, 45, 43, 41, 39, 37, 35, 33, 31, 30, 28, 26, 24}
+  },
+  //MAP_MASTER_PYRAMID
+  {
+    { 25, 26, 28, 30, 32, 34, 36, 38, 40, 41, 43, 45, 47, 49, 51, 53, 55, 57, 59, 61, 63, 65, 67, 69, 71, 73, 75, 77, 79, 81, 83, 85},
+    { 24, 26, 28, 29, 31, 33, 35, 37, 39, 41, 43, 45, 47, 49, 51, 53, 55, 57, 59, 61, 63, 65, 67, 69, 71, 73, 75, 77, 79, 81, 82, 84},
+    { 23, 25, 27, 29, 31, 33, 35, 37, 39, 41, 43, 45, 47, 49, 50, 52, 54, 56, 58, 60, 62, 64, 66, 68, 70, 72, 74, 76, 78, 80, 82, 84},
+    { 23, 25, 26, 28, 30, 32, 34, 36, 38, 40, 42, 44, 46, 48, 50, 52, 54, 56, 58, 60, 62, 64, 66, 68, 70, 72, 74, 76, 78, 80, 82, 84},
+    { 22, 24, 26, 28, 30, 32, 34, 36, 38, 40, 42, 44, 46, 48, 50, 52, 54, 56, 58, 60, 62, 64, 66, 68, 70, 72, 74, 76, 78, 80, 82, 84},
+    { 22, 24, 26, 28, 30, 32, 34, 36, 38, 40, 42, 44, 46, 48, 50, 52, 54, 56, 58, 60, 62, 64, 66, 68, 70, 72, 74, 76, 78, 80, 82, 84},
+    { 22, 24, 26, 28, 30, 32, 34, 36, 38, 40, 42, 44, 46, 48, 50, 52, 54, 56, 58, 60, 62, 64, 66, 68, 70, 72, 74, 76, 78, 80, 82, 84},
+    { 22, 24, 26, 28, 30, 32, 34, 36, 38, 40, 42, 44, 46, 48, 50, 52, 54, 56, 58, 60, 62, 64, 66, 68, 70, 72, 74, 76, 78, 80, 82, 84},
+    { 23, 25, 26, 28, 30, 32, 34, 36, 38, 40, 42, 44, 46, 48, 50, 52, 54, 56, 58, 60, 62, 64, 66, 68, 70, 72, 74, 76, 78, 80, 82, 84},
+    { 23, 25, 27, 29, 31, 33, 35, 37, 39, 41, 43, 45, 47, 49, 50, 52, 54, 56, 58, 60, 62, 64, 66, 68, 70, 72, 74, 76, 78, 80, 82, 84},
+    { 24, 26, 28, 29, 31, 33, 35, 37, 39, 41, 43, 45, 47, 49, 51, 53, 55, 57, 59, 61, 63, 65, 67, 69, 71, 73, 75, 77, 79, 81, 82, 84},
+    { 25, 26, 28, 30, 32, 34, 36, 38, 40, 41, 43, 45, 47, 49, 51, 53, 55, 57, 59, 61, 63, 65, 67, 69, 71, 73, 75, 77, 79, 81, 83, 85}
+  },
+  //MAP_SECONDARY_PYRAMID
+  {
+    { 84, 82, 80, 78, 76, 74, 72, 70, 68, 66, 64, 62, 61, 59, 57, 55, 53, 51, 49, 47, 45, 43, 41, 39, 37, 35, 33, 31, 30, 28, 26, 24},
+    { 84, 82, 80, 78, 76, 74, 72, 70, 68, 66, 64, 62, 60, 58, 56, 54, 52, 50, 48, 46, 44, 42, 41, 39, 37, 35, 33, 31, 29, 27, 25, 23},
+    { 84, 82, 80, 78, 76, 74, 72, 70, 68, 66, 64, 62, 60, 58, 56, 54, 52, 50, 48, 46, 44, 42, 40, 38, 36, 34, 32, 30, 28, 26, 25, 23},
+    { 84, 82, 80, 78, 76, 74, 72, 70, 68, 66, 64, 62, 60, 58, 56, 54, 52, 50, 48, 46, 44, 42, 40, 38, 36, 34, 32, 30, 28, 26, 24, 22},
+    { 84, 82, 80, 78, 76, 74, 72, 70, 68, 66, 64, 62, 60, 58, 56, 54, 52, 50, 48, 46, 44, 42, 40, 38, 36, 34, 32, 30, 28, 26, 24, 22},
+    { 84, 82, 80, 78, 76, 74, 72, 70, 68, 66, 64, 62, 60, 58, 56, 54, 52, 50, 48, 46, 44, 42, 40, 38, 36, 34, 32, 30, 28, 26, 24, 22},
+    { 84, 82, 80, 78, 76, 74, 72, 70, 68, 66, 64, 62, 60, 58, 56, 54, 52, 50, 48, 46, 44, 42, 40, 38, 36, 34, 32, 30, 28, 26, 24, 22},
+    { 84, 82, 80, 78, 76, 74, 72, 70, 68, 66, 64, 62, 60, 58, 56, 54, 52, 50, 48, 46, 44, 42, 40, 38, 36, 34, 32, 30, 28, 26, 24, 22},
+    { 84, 82, 80, 78, 76, 74, 72, 70, 68, 66, 64, 62, 60, 58, 56, 54, 52, 50, 48, 46, 44, 42, 40, 38, 36, 34, 32, 30, 28, 26, 24, 22},
+    { 84, 82, 80, 78, 76, 74, 72, 70, 68, 66, 64, 62, 60, 58, 56, 54, 52, 50, 48, 46, 44, 42, 40, 38, 36, 34, 32, 30, 28, 26, 25, 23},
+    { 84, 82, 80, 78, 76, 74, 72, 70, 68, 66, 64, 62, 60, 58, 56, 54, 52, 50, 48, 46, 44, 42, 41, 39, 37, 35, 33, 31, 29, 27, 25, 23},
+    { 84, 82, 80, 78, 76, 74, 72, 70, 68, 66, 64, 62, 61, 59, 57, 55, 53, 51, 49, 47, 45, 43, 41, 39, 37, 35, 33, 31, 30, 28, 26, 24}
+  },
+  //MAP_MASTER_END
+  {
+    { 33, 35, 37, 39, 41, 43, 45, 47, 49, 51, 53, 55, 57, 59, 61, 63, 65, 67, 69, 71, 73, 75, 77, 79, 81, 83, 85, 87, 89, 91, 93, 95},
+    { 33, 35, 37, 39, 41, 43, 45, 47, 49, 51, 53, 55, 57, 59, 61, 63, 65, 67, 69, 71, 73, 75, 77, 79, 81, 83, 85, 87, 89, 91, 93, 95},
+    { 33, 35, 37, 39, 41, 43, 45, 47, 49, 51, 53, 55, 57, 59, 61, 63, 65, 67, 69, 71, 73, 75, 77, 79, 81, 83, 85, 87, 89, 91, 93, 95},
+    { 33, 35, 37, 39, 41, 43, 45, 47, 49, 51, 53, 55, 57, 59, 61, 63, 65, 67, 69, 71, 73, 75, 77, 79, 81, 83, 85, 87, 89, 91, 93, 95},
+    { 33, 35, 37, 39, 41, 43, 45, 47, 49, 51, 53, 55, 57, 59, 61, 63, 65, 67, 69, 71, 73, 75, 77, 79, 81, 83, 85, 87, 89, 91, 93, 95},
+    { 33, 35, 37, 39, 41, 43, 45, 47, 49, 51, 53, 55, 57, 59, 61, 63, 65, 67, 69, 71, 73, 75, 77, 79, 81, 83, 85, 87, 89, 91, 93, 95},
+    { 33, 35, 37, 39, 41, 43, 45, 47, 49, 51, 53, 55, 57, 59, 61, 63, 65, 67, 69, 71, 73, 75, 77, 79, 81, 83, 85, 87, 89, 91, 93, 95},
+    { 33, 35, 37, 39, 41, 43, 45, 47, 49, 51, 53, 55, 57, 59, 61, 63, 65, 67, 69, 71, 73, 75, 77, 79, 81, 83, 85, 87, 89, 91, 93, 95},
+    { 33, 35, 37, 39, 41, 43, 45, 47, 49, 51, 53, 55, 57, 59, 61, 63, 65, 67, 69, 71, 73, 75, 77, 79, 81, 83, 85, 87, 89, 91, 93, 95},
+    { 33, 35, 37, 39, 41, 43, 45, 47, 49, 51, 53, 55, 57, 59, 61, 63, 65, 67, 69, 71, 73, 75, 77, 79, 81, 83, 85, 87, 89, 91, 93, 95},
+    { 33, 35, 37, 39, 41, 43, 45, 47, 49, 51, 53, 55, 57, 59, 61, 63, 65, 67, 69, 71, 73, 75, 77, 79, 81, 83, 85, 87, 89, 91, 93, 95},
+    { 33, 35, 37, 39, 41, 43, 45, 47, 49, 51, 53, 55, 57, 59, 61, 63, 65, 67, 69, 71, 73, 75, 77, 79, 81, 83, 85, 87, 89, 91, 93, 95}
+  },
+  //MAP_SECONDARY_END
+  {
+    { 94, 92, 90, 88, 86, 84, 82, 80, 78, 76, 74, 72, 70, 68, 66, 64, 62, 60, 58, 56, 54, 52, 50, 48, 46, 44, 42, 40, 38, 36, 34, 32},
+    { 94, 92, 90, 88, 86, 84, 82, 80, 78, 76, 74, 72, 70, 68, 66, 64, 62, 60, 58, 56, 54, 52, 50, 48, 46, 44, 42, 40, 38, 36, 34, 32},
+    { 94, 92, 90, 88, 86, 84, 82, 80, 78, 76, 74, 72, 70, 68, 66, 64, 62, 60, 58, 56, 54, 52, 50, 48, 46, 44, 42, 40, 38, 36, 34, 32},
+    { 94, 92, 90, 88, 86, 84, 82, 80, 78, 76, 74, 72, 70, 68, 66, 64, 62, 60, 58, 56, 54, 52, 50, 48, 46, 44, 42, 40, 38, 36, 34, 32},
+    { 94, 92, 90, 88, 86, 84, 82, 80, 78, 76, 74, 72, 70, 68, 66, 64, 62, 60, 58, 56, 54, 52, 50, 48, 46, 44, 42, 40, 38, 36, 34, 32},
+    { 94, 92, 90, 88, 86, 84, 82, 80, 78, 76, 74, 72, 70, 68, 66, 64, 62, 60, 58, 56, 54, 52, 50, 48, 46, 44, 42, 40, 38, 36, 34, 32},
+    { 94, 92, 90, 88, 86, 84, 82, 80, 78, 76, 74, 72, 70, 68, 66, 64, 62, 60, 58, 56, 54, 52, 50, 48, 46, 44, 42, 40, 38, 36, 34, 32},
+    { 94, 92, 90, 88, 86, 84, 82, 80, 78, 76, 74, 72, 70, 68, 66, 64, 62, 60, 58, 56, 54, 52, 50, 48, 46, 44, 42, 40, 38, 36, 34, 32},
+    { 94, 92, 90, 88, 86, 84, 82, 80, 78, 76, 74, 72, 70, 68, 66, 64, 62, 60, 58, 56, 54, 52, 50, 48, 46, 44, 42, 40, 38, 36, 34, 32},
+    { 94, 92, 90, 88, 86, 84, 82, 80, 78, 76, 74, 72, 70, 68, 66, 64, 62, 60, 58, 56, 54, 52, 50, 48, 46, 44, 42, 40, 38, 36, 34, 32},
+    { 94, 92, 90, 88, 86, 84, 82, 80, 78, 76, 74, 72, 70, 68, 66, 64, 62, 60, 58, 56, 54, 52, 50, 48, 46, 44, 42, 40, 38, 36, 34, 32},
+    { 94, 92, 90, 88, 86, 84, 82, 80, 78, 76, 74, 72, 70, 68, 66, 64, 62, 60, 58, 56, 54, 52, 50, 48, 46, 44, 42, 40, 38, 36, 34, 32}
+  }
+};
+
+/*******************************************************************************
+* Function: Map_To_Grid(MAP_POINT point, UINT8 *px, UINT8 *py)
+*
+* Variables:
+* point -> A position on the table
+* *px -> Stores the column of the closest grid pixel (0-31)
+* *py -> Stores the row of the closest grid pixel (0-11)
+*
+* Description:
+* This function finds the LED grid pixel that is closest to a position on the
+* table. Positions off of the grid are moved to the edge of the grid.
+*******************************************************************************/
+void Map_To_Grid(MAP_POINT point, UINT8 *px, UINT8 *py)
+{
+  if (point.x < MAP_GRID_X)
+    *px = 0;
+  else if (point.x >= (MAP_GRID_X + GRID_X_MAX * MAP_GRID_SCALE))
+    *px = GRID_X_MAX - 1;
+  else
+    *px = (point.x - MAP_GRID_X) / MAP_GRID_SCALE;
+
+  if (point.y < MAP_GRID_Y)
+    *py = 0;
+  else if (point.y >= (MAP_GRID_Y + GRID_Y_MAX * MAP_GRID_SCALE))
+    *py = GRID_Y_MAX - 1;
+  else
+    *py = (point.y - MAP_GRID_Y) / MAP_GRID_SCALE;
+}
+
+/*******************************************************************************
+* Function: Map_Fade_Pods(UINT8 center, UINT8 r_min, UINT8 r_max, RGB color, 
+*                         UINT16 fade_rate)
+*
+* Variables:
+* center -> The center that the distances are measured from (MAP_xxx)
+* r_min -> The pods that are at least this far from the center are faded
+* r_max -> The pods that are this far or further from the center are not faded
+* color -> The color to fade the pods to
+* fade_rate -> The fade rate of the pods
+*
+* Description:
+* This function fades every pod (1-20) that is between r_min and r_max from
+* 'center' to 'color'.
+*******************************************************************************/
+void Map_Fade_Pods(UINT8 center, UINT8 r_min, UINT8 r_max, RGB color, UINT16 fade_rate)
+{
+  UINT8 i;
+
+  for (i = 1;i <= 20;i++)
+  {
+    if ((pod_distance[center][i] >= r_min) && (pod_distance[center][i] < r_max))
+      Fade_Pod(i,color,fade_rate);
+  }
+}
+
+/*******************************************************************************
+* Function: Map_Fade_Rings(UINT8 center, UINT8 r_min, UINT8 r_max, UINT16 level,
+*                          UINT16 fade_rate)
+*
+* Variables:
+* center -> The center that the distances are measured from (MAP_xxx)
+* r_min -> The rings that are at least this far from the center are faded
+* r_max -> The rings that are this far or further from the center are not faded
+* level -> The brightness to fade the rings to
+* fade_rate -> The fade rate of the rings
+*
+* Description:
+* This function fades every LED ring that is between r_min and r_max from
+* 'center' to 'level'. The ball washer rings (9-12) are skipped while a ball
+* washer is running.
+*******************************************************************************/
+void Map_Fade_Rings(UINT8 center, UINT8 r_min, UINT8 r_max, UINT16 level, UINT16 fade_rate)
+{
+  UINT8 i;
+
+  for (i = 1;i <= 16;i++)
+  {
+    //Leave the ball washer LED rings alone while they are in use
+    if ((BW_ACTIVE == 1) && (i >= 9) && (i <= 12))
+      continue;
+
+    if ((ring_distance[center][i] >= r_min) && (ring_distance[center][i] < r_max))
+      Fade_Ring(i,level,fade_rate);
+  }
+}
+
+/*******************************************************************************
+* Function: Map_Grid_Band(UINT8 center, UINT8 py, UINT8 r_min, UINT8 r_max)
+*
+* Variables:
+* center -> The center that the distances are measured from (MAP_xxx)
+* py -> The grid row (0-11)
+* r_min -> The pixels that are at least this far from the center are set
+* r_max -> The pixels that are this far or further from the center are not set
+*
+* Description:
+* This function returns the pixels of grid row 'py' that are between r_min and 
+* r_max from 'center', in the same format as grid_row[12].
+*******************************************************************************/
+UINT32 Map_Grid_Band(UINT8 center, UINT8 py, UINT8 r_min, UINT8 r_max)
+{
+  UINT8 i;
+  UINT8 distance;
+  UINT32 row = 0;
+
+  for (i = 0;i < GRID_X_MAX;i++)
+  {
+    distance = grid_distance[center][py][i];
+
+    if ((distance >= r_min) && (distance < r_max))
+      row |= ((UINT32) 1) << i;
+  }
+
+  return row;
+}
+
+/*******************************************************************************
+* Function: Map_Draw_Band(UINT8 center, UINT8 r_min, UINT8 r_max)
+*
+* Variables:
+* center -> The center that the distances are measured from (MAP_xxx)
+* r_min -> The pixels that are at least this far from the center are drawn
+* r_max -> The pixels that are this far or further from the center are not drawn
+*
+* Description:
+* This function draws every grid pixel that is between r_min and r_max from
+* 'center'. This function will only modify the grid data, to actually write it
+* to the grid the user must call UPDATE_FRAME() after this function.
+*******************************************************************************/
+void Map_Draw_Band(UINT8 center, UINT8 r_min, UINT8 r_max)
+{
+  UINT8 i;
+
+  for (i = 0;i < GRID_Y_MAX;i++)
+    grid_row[i] |= Map_Grid_Band(center,i,r_min,r_max);
+}
+
+#endif
@@ -0,0 +1,58 @@
+/*******************************************************************************
+* Title: Table_Map.h
+* Version: 1.0
+* Author: robotros
+* Date: October 19, 2026
+*
+* Description:
+* This file contains the definitions and function prototypes for the spatial map
+* of the table. The map gives the physical position of every RGB pod, LED ring
+* and LED grid pixel so that effects can be written once and applied to all of
+* the outputs on the table.
+*******************************************************************************/
+
+#ifndef TABLE_MAP_H
+#define TABLE_MAP_H
+
+/*************************************************
+*                   Constants                    *
+*************************************************/
+//Table positions run from 0 - 255 along the length of the table (the MASTER
+//SIDE is at 0) and 0 - 63 across the width of the table.
+#define MAP_X_MAX             255
+#define MAP_Y_MAX             63
+
+//Where the LED grid sits on the table. Each grid pixel is MAP_GRID_SCALE
+//table positions wide.
+#define MAP_GRID_X            64
+#define MAP_GRID_Y            8
+#define MAP_GRID_SCALE        4
+
+//The centers that distances are measured from. Distances are in half grid
+//pixels (2 table positions).
+#define MAP_CENTERS           6
+
+#define MAP_TABLE_CENTER      0   //Middle of the table (underlighting pod 21)
+#define MAP_PYRAMIDS          1   //Closest of the two pyramid centers (pods 5 & 15)
+#define MAP_MASTER_PYRAMID    2   //Center of the MASTER SIDE pyramid (pod 5)
+#define MAP_SECONDARY_PYRAMID 3   //Center of the SECONDARY SIDE pyramid (pod 15)
+#define MAP_MASTER_END        4   //Sweeps from the MASTER SIDE end of the table
+#define MAP_SECONDARY_END     5   //Sweeps from the SECONDARY SIDE end of the table
+
+//Stores a position on the table
+typedef struct
+{
+  UINT8 x;
+  UINT8 y;
+} MAP_POINT;
+
+/*************************************************
+*              Function Prototypes               *
+*************************************************/
+void Map_To_Grid(MAP_POINT point, UINT8 *px, UINT8 *py);
+void Map_Fade_Pods(UINT8 center, UINT8 r_min, UINT8 r_max, RGB color, UINT16 fade_rate);
+void Map_Fade_Rings(UINT8 center, UINT8 r_min, UINT8 r_max, UINT16 level, UINT16 fade_rate);
+UINT32 Map_Grid_Band(UINT8 center, UINT8 py, UINT8 r_min, UINT8 r_max);
+void Map_Draw_Band(UINT8 center, UINT8 r_min, UINT8 r_max);
+
+#endif
@@ -13,6 +13,8 @@
 #define TIMERS_SETUP_C
 
 #include "Main_Includes.h"
+#include "ADC_Setup.h"
+#include "Interrupts.h"
 #include "Timers_Setup.h"
 
 /*******************************************************************************
@@ -26,8 +28,9 @@
 *******************************************************************************/
 void TMR1_Init(void)
 { 
-  //Set priority to 6 (2nd highest), clear interrupt flag and enable interrupt
-  IPC0bits.T1IP = 6;	 
+  //Set priority to 5, below the ADC (6) so that the ~1ms TLC5955 write can't
+  //hold up the conversions. Clear interrupt flag and enable interrupt
+  IPC0bits.T1IP = 5;	 
   IFS0bits.T1IF = 0;	 
   IEC0bits.T1IE = 1;	
   
@@ -62,14 +65,16 @@ void TMR2_Init(void)
 *******************************************************************************/
 void TMR3_Init(void)
 {
-  //Set priority to 5 (3rd highest), clear interrupt flag and enable interrupt
+  //Set priority to 5 (3rd highest), clear interrupt flag and disable interrupt.
+  //Timer3 only triggers the ADC, which doesn't need the interrupt.
   IPC2bits.T3IP = 5;	 
   IFS0bits.T3IF = 0;	 
-  IEC0bits.T3IE = 1;
+  IEC0bits.T3IE = 0;
   
-  //Prescaler -> 1:8, Internal clock, Interrupt period -> 1ms
-  PR3 = 8750;
-  T3CON = 0x8010;  	 
+  //Prescaler -> 1:1, Internal clock, Period -> 250us / ADC_OVERSAMPLE
+  //Timer3 triggers the ADC conversions for the IR sensors
+  PR3 = TMR3_PERIOD;
+  T3CON = 0x8000;  	 
 }
 
 /*******************************************************************************
@@ -113,6 +118,11 @@ void TMR5_Init(void)
   PR5 = 8750;
   T5CON = 0x8010; 
   
+  //The LED refresh that Timer5 sets off runs in the INT1 interrupt, below the
+  //ADC and Timer1 (so it never changes TLC_data2[] in the middle of a write).
+  //INT1 isn't mapped to a pin (RPINR0 = Vss), so only Timer5 sets it.
+  INT1_Init(ON,INT1_POSITIVE_EDGE,INT_PRIORITY4);
+  
 }
 
 #endif
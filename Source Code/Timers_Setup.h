@@ -15,6 +15,9 @@
 /*************************************************
 *                  Constants                     *
 *************************************************/    
+//Timer3 runs every 250us / ADC_OVERSAMPLE (ADC_Setup.h) so that it can trigger
+//the background ADC conversions of the IR sensors. Its interrupt is not used.
+#define TMR3_PERIOD       (17500 / ADC_OVERSAMPLE)
 
 /*************************************************
 *                   Macros                       *
@@ -134,6 +134,9 @@ typedef struct
     UINT32 total_sectors;
     UINT32 total_clusters;
     UINT32 root_dir_cluster;
+    UINT32 fsinfo_sector;
+    UINT32 free_clusters;
+    UINT32 next_free;
 } FILE_SYSTEM; 
 
 //Bit Variables
@@ -27,6 +27,229 @@ extern volatile T16_FLAG FLAG1;
 
 extern volatile UINT32 count32;
 extern volatile UINT32 grid_row[12];
+extern volatile UINT32 msgeq7_top[7];
+extern volatile const UINT8 msgeq7_db[1024];
+extern UINT16 beat_bpm;
+
+//The smoothed level and the held peak of each band (8.8 fixed point), the speed
+//each level is falling at (8.8 levels per second) and when each peak was set
+UINT16 vu_level[7] = {0,0,0,0,0,0,0};
+UINT16 vu_peak[7] = {0,0,0,0,0,0,0};
+UINT32 vu_speed[7];
+UINT32 vu_peak_mark[7];
+
+/*******************************************************************************
+* Function: VU_Update(UINT16 *level, UINT32 time, UINT16 *display)                                                                     
+*                                                                               
+* Variables:                                                                    
+* *level -> The seven band levels (0 - 31) from MSGEQ7_Auto_Adjust(a,b)
+* time -> When the bands were read (count32, see MSGEQ7_Read())
+* *display -> Stores the seven smoothed levels (0 - 31) for the VU animations
+*                                                                               
+* Description:                                                                  
+* This function moves the level and the peak of each band towards the new 
+* reading by the time since the last reading, using the VU_ ballistics. Calling
+* it more often than the bands are read changes nothing, so the VU animations 
+* move at the same speed however busy the main loop is.
+*******************************************************************************/
+void VU_Update(UINT16 *level, UINT32 time, UINT16 *display)
+{
+	static UINT32 mark = 0;
+	
+	UINT8 i;
+	UINT16 dt;
+	UINT16 target;
+	UINT32 drop;
+	
+	//Limit the time so a long pause doesn't overflow
+	if ((time - mark) > 1000)
+		dt = 1000;
+	else
+		dt = time - mark;
+		
+	mark = time;
+	
+	for (i = 0;i < 7;i++)
+	{
+		target = level[i] << 8;
+		
+		//Rise quickly to a louder level
+		if (target >= vu_level[i])
+		{
+			if (dt >= VU_ATTACK_TIME)
+				vu_level[i] = target;
+			else
+				vu_level[i] += ((UINT32) (target - vu_level[i]) * dt) / VU_ATTACK_TIME;
+			
+			vu_speed[i] = (UINT32) VU_FALL_SPEED << 8;
+		}
+		
+		//Fall, speeding up the longer the level has been falling
+		else
+		{
+			drop = (vu_speed[i] * dt) / 1000;
+			vu_speed[i] += (((UINT32) VU_FALL_GRAVITY << 8) * dt) / 1000;
+			
+			if ((vu_level[i] - target) > drop)
+				vu_level[i] -= drop;
+			else
+				vu_level[i] = target;
+		}
+		
+		//Hold the peak, then let it fall at a steady speed
+		if (target >= vu_peak[i])
+		{
+			vu_peak[i] = target;
+			vu_peak_mark[i] = time;
+		}
+		
+		else if ((time - vu_peak_mark[i]) > VU_PEAK_HOLD_TIME)
+		{
+			drop = (((UINT32) VU_PEAK_FALL_SPEED << 8) * dt) / 1000;
+			
+			if ((vu_peak[i] - target) > drop)
+				vu_peak[i] -= drop;
+			else
+				vu_peak[i] = target;
+		}
+		
+		display[i] = (vu_level[i] + 128) >> 8;
+	}
+}
+
+/*******************************************************************************
+* Function: VU_Peak(UINT8 band)                                                                     
+*                                                                               
+* Variables:                                                                    
+* band -> The frequency band (0 - 6)
+*                                                                               
+* Description:                                                                  
+* This function returns the held peak level (0 - 31) of a band (see VU_Update()).
+*******************************************************************************/
+UINT16 VU_Peak(UINT8 band)
+{
+	return (vu_peak[band] + 128) >> 8;
+}
+
+/*******************************************************************************
+* Function: VU_Range(UINT8 mode)                                                                     
+*                                                                               
+* Variables:                                                                    
+* mode -> The VU mode (the value of 'VU_Meter')
+*                                                                               
+* Description:                                                                  
+* This function returns the dynamic range in dB that the levels of a VU mode are
+* spread over (see MSGEQ7_Set_Range()).
+*******************************************************************************/
+UINT8 VU_Range(UINT8 mode)
+{
+	switch (mode)
+	{
+		case 2:  return VU_RANGE_MODE1;
+		case 3:  return VU_RANGE_MODE2;
+		case 4:  return VU_RANGE_MODE3;
+		default: return VU_RANGE_DEFAULT;
+	}
+}
+
+/*******************************************************************************
+* Function: VU_Director(UINT8 mode)                                                                     
+*                                                                               
+* Variables:                                                                    
+* mode -> The current VU mode (the value of 'VU_Meter')
+*                                                                               
+* Description:                                                                  
+* This function picks the VU mode while VU_AUTO is set and returns it. It uses
+* the top of each band that MSGEQ7_Auto_Adjust(a,b) already follows, so it only
+* costs a few lookups and adds every DIRECTOR_UPDATE_TIME ms. When the music 
+* drops, the loud mode is picked, on a breakdown the quiet mode, and when the
+* balance between the bass and the highs moves (a new section), the next mode.
+* Otherwise the modes take turns every DIRECTOR_MAX_TIME ms. The new mode starts
+* on a kick (see MSGEQ7_Beat()).
+*******************************************************************************/
+UINT8 VU_Director(UINT8 mode)
+{
+	static UINT32 tmark = 0;
+	static UINT32 switch_mark = 0;
+	static UINT32 pick_mark = 0;
+	static UINT32 fast = 0;
+	static UINT32 slow = 0;
+	static INT32 fast_tilt = 0;
+	static INT32 slow_tilt = 0;
+	static UINT16 beats = 0;
+	static UINT8 next = 0;
+	
+	UINT8 i;
+	UINT8 beat;
+	UINT16 energy = 0;
+	INT16 tilt;
+	INT16 change;
+	
+	//Keep the beat cursor up to date so only new beats are seen
+	beat = MSGEQ7_Beat(&beats);
+	
+	//A new mode has been picked, start it on the next kick
+	if (next)
+	{
+		if ((beat & BEAT_KICK) || ((count32 - pick_mark) > DIRECTOR_BEAT_WAIT))
+		{
+			mode = next;
+			next = 0;
+			switch_mark = count32;
+			
+			//The new section is now what the music is compared to
+			slow = (fast >> DIRECTOR_FAST_SHIFT) << DIRECTOR_SLOW_SHIFT;
+			slow_tilt = (fast_tilt >> DIRECTOR_FAST_SHIFT) << DIRECTOR_SLOW_SHIFT;
+		}
+		
+		return mode;
+	}
+	
+	if (!Time_Check(&tmark,DIRECTOR_UPDATE_TIME))
+		return mode;
+	
+	//Find the loudness of all bands and the tilt in 1/4 dB
+	for (i = 0;i < 7;i++)
+		energy += msgeq7_db[msgeq7_top[i] >> AGC_FRAC];
+		
+	tilt = (INT16) (msgeq7_db[msgeq7_top[5] >> AGC_FRAC] + msgeq7_db[msgeq7_top[6] >> AGC_FRAC])
+	     - (INT16) (msgeq7_db[msgeq7_top[0] >> AGC_FRAC] + msgeq7_db[msgeq7_top[1] >> AGC_FRAC]);
+	
+	//Update the averages. They are kept at 2^SHIFT times their value.
+	fast += energy - (fast >> DIRECTOR_FAST_SHIFT);
+	slow += energy - (slow >> DIRECTOR_SLOW_SHIFT);
+	fast_tilt += tilt - (fast_tilt >> DIRECTOR_FAST_SHIFT);
+	slow_tilt += tilt - (slow_tilt >> DIRECTOR_SLOW_SHIFT);
+	
+	if ((count32 - switch_mark) < DIRECTOR_MIN_TIME)
+		return mode;
+	
+	change = (INT16) (fast >> DIRECTOR_FAST_SHIFT) - (INT16) (slow >> DIRECTOR_SLOW_SHIFT);
+	tilt = (INT16) (fast_tilt >> DIRECTOR_FAST_SHIFT) - (INT16) (slow_tilt >> DIRECTOR_SLOW_SHIFT);
+	
+	if (change > DIRECTOR_DROP)
+		next = DIRECTOR_MODE_LOUD;
+	
+	else if (change < -DIRECTOR_DROP)
+		next = DIRECTOR_MODE_QUIET;
+	
+	else if ((tilt > DIRECTOR_TILT) || (tilt < -DIRECTOR_TILT) || ((count32 - switch_mark) > DIRECTOR_MAX_TIME))
+		next = mode + 1;
+		
+	else
+		return mode;
+	
+	//Always show something new at a boundary
+	if (next == mode)
+		next++;
+		
+	if (next > DIRECTOR_MODE_QUIET)
+		next = DIRECTOR_MODE_LOUD;
+		
+	pick_mark = count32;
+	
+	return mode;
+}
 
 /*******************************************************************************
 * Function: Pods_VU_Mode1(UINT16 *signal)                                                                     
@@ -338,6 +561,55 @@ void Pods_VU_Mode2(UINT16 signal)
 }
 
 
+/*******************************************************************************
+* Function: Rings_VU_Mode1(UINT16 *signal)                                                                     
+*                                                                               
+* Variables:                                                                    
+* *signal -> The seven smoothed band levels (0 - 31) from VU_Update()
+*                                                                               
+* Description:                                                                  
+* This function flashes the 8 LED rings on the rails with the beats of the music
+* (see MSGEQ7_Beat()). A kick flashes all of them as bright as the 63Hz band, a
+* snare only every other ring as bright as the 2.5kHz band. Once the tempo has 
+* been found (beat_bpm), each flash fades out over one beat, so the rings pulse
+* in time with the music. Call it every loop, the rings are only changed on a beat.
+*******************************************************************************/
+void Rings_VU_Mode1(UINT16 *signal)
+{
+	static UINT16 beats = 0;
+	
+	UINT8 i;
+	UINT8 beat;
+	UINT16 fade;
+	UINT16 duty;
+	
+	beat = MSGEQ7_Beat(&beats);
+	
+	if (!beat)
+		return;
+	
+	//Fade out over one beat, or VU_RING_FADE until the tempo is known
+	if (beat_bpm)
+		fade = 60000UL / beat_bpm;
+	else
+		fade = VU_RING_FADE;	
+	
+	//The brightness follows the band the hit was heard in (0 - 31)
+	if (beat & BEAT_KICK)
+		duty = ((UINT32) (signal[0] + 1) * RING_MAX) >> 5;
+	else
+		duty = ((UINT32) (signal[4] + 1) * RING_MAX) >> 5;
+	
+	for (i = 1;i <= 8;i++)
+	{
+		if ((beat & BEAT_KICK) || (i & 0x01))
+		{
+			Update_Ring(i,duty);
+			Fade_Ring(i,RING_MIN,fade);
+		}	
+	}
+}
+
 /*******************************************************************************
 * Function: Display_Data(UINT16 *channel)                                                                     
 *                                                                               
@@ -361,59 +633,32 @@ void Display_Data(UINT16 *channel)
 }  
 
 /*******************************************************************************
-* Function: Bargraph_Update(UINT16 signal)                                                                     
+* Function: Bargraph_Update(UINT16 signal, UINT16 peak)                                                                     
 *                                                                               
 * Variables:                                                                 
-* signal -> Contains the adjusted ADC reading of one of the frequency channels       
+* signal -> Contains the smoothed level of one of the frequency channels (see VU_Update())
+* peak -> Contains the held peak of the same channel (see VU_Peak())
 *                                                                               
 * Description:                                                                  
-* This function will display a bargraph VU meter display across the LED grid.                                                                              
+* This function will display a bargraph VU meter display across the LED grid, 
+* with a single pixel showing the peak.
 *******************************************************************************/
-void Bargraph_Update(UINT16 signal)
+void Bargraph_Update(UINT16 signal, UINT16 peak)
 {
   UINT8 i;
   UINT32 value;
-  static UINT8 last_level = 0;
-  static UINT32 tmark = 0;
   
-  //If the signal is smaller than the previous one, only decrease the bargraph by 1
-  if (signal < last_level)
-	{
-		//Create a time delay so that the bargraph isnt sporadic
-	  if (Time_Check(&tmark,11))
-	  {
-		  //Decrease the bargraph by 1 level
-			signal = last_level - 1;
-			
-			//Modify the grid to display the new bargraph size
-			for (i = 0;i < GRID_Y_MAX;i++)
-			{
-				value = ((UINT32)1 << signal) - 1;
-				value <<= 1;
-				value |= 1;
-				
-				grid_row[i] = value;
-			}	
-			
-			//Store the current reading for the next loop
-		  last_level = signal;			
-	 }
-  }
- 
-  //The signal is greater than the last one 
-  else 
-  {
-	 
-	 //Update the grid to display the new bargraph size
-	 for (i = 0;i < GRID_Y_MAX;i++)
-	 {
-	 	 value = ((UINT32)1 << signal) - 1;
-	 	 value <<= 1;
-		 value |= 1;
-				
-		 grid_row[i] = value;
-	 }		 		  
-	}		
+  //Light one pixel for each level, plus one so there is always a bar
+  value = ((UINT32)1 << signal) - 1;
+  value <<= 1;
+  value |= 1;
+  
+  //Add the peak pixel
+  value |= (UINT32)1 << peak;
+  
+  //Modify the grid to display the new bargraph size
+  for (i = 0;i < GRID_Y_MAX;i++)
+    grid_row[i] = value;
 	
 	//Update the LED grid
 	UPDATE_FRAME();	 
@@ -423,50 +668,19 @@ void Bargraph_Update(UINT16 signal)
 * Function: Grid_VU_Mode1(UINT16 signal)                                                                     
 *                                                                               
 * Variables:       
-* signal -> Contains the adjusted ADC reading of one of the frequency channels                                                              
+* signal -> Contains the smoothed level of one of the frequency channels (see VU_Update())
 *                                                                               
 * Description:         
 * This function displays a customized VU meter animation on the LED grid.                                                                
 *******************************************************************************/
 void Grid_VU_Mode1(UINT16 signal)
 {
-  static UINT8 last_level = 0;
-  static UINT32 tmark = 0;
-  
   //Clear the grid data
   Clear_Grid();
   
-  //Adjust the signal
-  signal = (float)signal * 0.6;
-  
-  //If the signal is smaller than the previous one, only decrease the level by 1
-  if (signal < last_level)
-	{
-		//If the signal is a 0 or a 1, reset it to 0
-  	if (last_level == 1 || last_level == 0)
-  	{
-    	signal = 0;
-    	return;
-    } 	
-  		
-		//Create a time delay so that the animation isnt sporadic
-	  if (Time_Check(&tmark,8))
-	  {
-		  //Decrease the bargraph by 1 level
-			signal = last_level - 1;
-			
-			//Draw a circle in the middle of the grid, with its radius determined by the
-			//intensity of the signal
-			Draw_Circle(15,5,signal);
-			
-			//Store the current reading for the next loop
-		  last_level = signal;			
-	  }
-  }
- 
-  //The new signal reading is larger than the last, update the animation
-  else 
-	  Draw_Circle(15,5,signal);			  	
+  //Draw a circle in the middle of the grid, with its radius determined by the
+  //intensity of the signal
+  Draw_Circle(15,5,(signal * 3) / 5);
 	
 	//Update the LED grid
   UPDATE_FRAME(); 
@@ -476,101 +690,53 @@ void Grid_VU_Mode1(UINT16 signal)
 * Function: Grid_VU_Mode2(UINT16 *signal)                                                                     
 *                                                                               
 * Variables:   
-* *signal -> Points to the adjusted ADC readings for each frequency channel                                                                     
+* *signal -> Points to the smoothed levels for each frequency channel (see VU_Update())
 *                                                                               
 * Description:                        
 * This function displays a customized VU meter animation on the LED grid.                                            
 *******************************************************************************/
 void Grid_VU_Mode2(UINT16 *signal)
 {
-  UINT8 i;
-  static UINT8 last_level[7] = {0,0,0,0,0,0,0};
-  UINT8 div = 14;
-  
   //Clear the grid data
   Clear_Grid();
   
-  //Adjust the signal levels as each circle has a smaller maximum radius
-  for (i = 0;i < 7;i++)
-  	signal[i] /= 5;
-  
-  //If the signal is smaller than the previous one, only decrease the level by 1
-  if (signal[0] < last_level[0])
- 	{
-		//Offset the signal
-		signal[0] = last_level[0] - div;
+  //Draw a small circle in a specific location on the LED grid for each of four
+  //channels, with the radius being determined by the instensity of the signal.
+  //Each circle has a smaller maximum radius, so the levels are scaled down.
+  Draw_Circle(4,3,signal[0] / 5);
+  Draw_Circle(12,8,signal[4] / 5);
+  Draw_Circle(27,8,signal[1] / 5);
+  Draw_Circle(20,3,signal[5] / 5);
 		
-		//Draw a small circle in a specific location on the LED grid, with the 
-		//radius being determined by the instensity of the signal	
-		Draw_Circle(4,3,signal[0]);
-			
-		//Store the current reading for the next loop
-		last_level[0] = signal[0];			
-	
-  }
- 
-  //The new signal reading is larger than the last, update the animation
-  else 
-	  Draw_Circle(4,3,signal[0]);		
+	//Update the LED grid
+	UPDATE_FRAME();	 
+}
+
+/*******************************************************************************
+* Function: Grid_Spectrum(UINT8 *height)                                                                     
+*                                                                               
+* Variables:   
+* *height -> Points to the height of each bar (one for each grid column)
+*                                                                               
+* Description:                        
+* This function draws the spectrum analyzer bars (see Spectrum_Update()) up from
+* the bottom of the LED grid, lowest frequency on the left.
+*******************************************************************************/
+void Grid_Spectrum(UINT8 *height)
+{
+  UINT8 x,y;
   
-  //If the signal is smaller than the previous one, only decrease the level by 1
-  if (signal[4] < last_level[4])
-	{	
-		//Offset the signal
-		signal[4] = last_level[4] - div;
-			
-		//Draw a small circle in a specific location on the LED grid, with the 
-		//radius being determined by the instensity of the signal	
-		Draw_Circle(12,7,signal[4]);
-			
-		//Store the current reading for the next loop
-		last_level[4] = signal[4];			
-	
-  }
- 
-  //The new signal reading is larger than the last, update the animation
-  else 
-	  Draw_Circle(12,8,signal[4]);		
+  //Clear the grid data
+  Clear_Grid();
   
-  //If the signal is smaller than the previous one, only decrease the level by 1
-  if (signal[1] < last_level[1])
-	{
-		//Offset the signal
-		signal[1] = last_level[1] - div;
-			
-		//Draw a small circle in a specific location on the LED grid, with the 
-		//radius being determined by the instensity of the signal	
-		Draw_Circle(27,8,signal[1]);
-			
-		//Store the current reading for the next loop
-		last_level[1] = signal[1];			
-	
+  for (x = 0;x < GRID_X_MAX;x++)
+  {
+    for (y = 0;y < height[x];y++)
+      grid_row[GRID_Y_MAX - 1 - y] |= (UINT32)1 << x;
   }
- 
-  //The new signal reading is larger than the last, update the animation
-  else 
-	  Draw_Circle(27,8,signal[1]);		
   
-  //If the signal is smaller than the previous one, only decrease the level by 1
-  if (signal[5] < last_level[5])
-	{	  
-		//Offset the signal
-		signal[5] = last_level[5] - div;
-			
-		//Draw a small circle in a specific location on the LED grid, with the 
-		//radius being determined by the instensity of the signal	
-		Draw_Circle(20,3,signal[5]);
-			
-		//Store the current reading for the next loop
-		last_level[5] = signal[5];			
-  }
- 
-  //The new signal reading is larger than the last, update the animation
-  else 
-	  Draw_Circle(20,3,signal[5]);			  	
-		
-	//Update the LED grid
-	UPDATE_FRAME();	 
+  //Update the LED grid
+  UPDATE_FRAME();
 }
  
 #endif
\ No newline at end of file
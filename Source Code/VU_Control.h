@@ -15,10 +15,65 @@
 /*************************************************
 *                   Constants                    *
 *************************************************/
+//VU ballistics used by VU_Update(). Times are in ms and speeds in levels per
+//second. A louder level is reached within VU_ATTACK_TIME. A quieter level is
+//fallen to at VU_FALL_SPEED, which grows by VU_FALL_GRAVITY every second, so
+//the bars drop slowly at first and then faster.
+#define VU_ATTACK_TIME        20
+#define VU_FALL_SPEED         20
+#define VU_FALL_GRAVITY       120
+
+//The peak of each band is held for VU_PEAK_HOLD_TIME and then falls at
+//VU_PEAK_FALL_SPEED
+#define VU_PEAK_HOLD_TIME     600
+#define VU_PEAK_FALL_SPEED    30
+
+//The dynamic range (dB) of the levels in each VU mode (see MSGEQ7_Set_Range()).
+//The pulsing circle looks best jumpy, the bargraph shows more of the quiet parts.
+#define VU_RANGE_MODE1        30
+#define VU_RANGE_MODE2        36
+#define VU_RANGE_MODE3        45
+
+//Set while VU_Director() picks the VU mode (MENU_VU_RANDOM)
+#define VU_AUTO               FLAG1.b14
+
+//The VU director checks the music every DIRECTOR_UPDATE_TIME ms. It keeps a
+//short (~0.8s) and a long (~6.4s) average of the loudness of all bands and of
+//the tilt (highest two bands - lowest two bands), in 1/4 dB.
+#define DIRECTOR_UPDATE_TIME  100
+#define DIRECTOR_FAST_SHIFT   3
+#define DIRECTOR_SLOW_SHIFT   6
+
+//A drop (or a breakdown) is when the short average of the loudness rises (or 
+//falls) DIRECTOR_DROP above (or below) the long one, ~6dB in every band. A new
+//section is when the tilt moves by DIRECTOR_TILT, ~8dB in each of its bands.
+#define DIRECTOR_DROP         (6 * 4 * 7)
+#define DIRECTOR_TILT         (8 * 4 * 2)
+
+//Each mode is shown for at least DIRECTOR_MIN_TIME ms and at most 
+//DIRECTOR_MAX_TIME ms. Once a new mode is picked, it starts on the next kick,
+//or after DIRECTOR_BEAT_WAIT ms if there isn't one.
+#define DIRECTOR_MIN_TIME     8000
+#define DIRECTOR_MAX_TIME     60000
+#define DIRECTOR_BEAT_WAIT    1500
+
+//Rings_VU_Mode1() fades each flash out over one beat of the music. Until the
+//tempo has been found, the flashes take VU_RING_FADE ms.
+#define VU_RING_FADE          300
+
+//The VU modes the director picks from (the values of 'VU_Meter')
+#define DIRECTOR_MODE_LOUD    2     //Pulsing circle, pods on each band, rings on the beat
+#define DIRECTOR_MODE_SHIFT   3     //Four circles
+#define DIRECTOR_MODE_QUIET   4     //Bargraph, rings on the beat
 
 /*************************************************
 *              Function Prototypes               *
 *************************************************/
+void VU_Update(UINT16 *level, UINT32 time, UINT16 *display);
+UINT16 VU_Peak(UINT8 band);
+UINT8 VU_Range(UINT8 mode);
+UINT8 VU_Director(UINT8 mode);
+
 void Pods_VU_Mode1(UINT16 *signal);
 void Pods_VU_Mode2(UINT16 signal);
 
@@ -28,6 +83,7 @@ void Grid_VU_Mode2(UINT16 *signal);
 void Rings_VU_Mode1(UINT16 *signal);
 
 void Display_Data(UINT16 *channel);
-void Bargraph_Update(UINT16 signal);
+void Bargraph_Update(UINT16 signal, UINT16 peak);
+void Grid_Spectrum(UINT8 *height);
 
 #endif
\ No newline at end of file
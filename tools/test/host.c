@@ -0,0 +1,36 @@
+/*******************************************************************************
+* Title: host.c
+* Version: 1.0
+* Author: robotros
+* Date: October 19, 2026
+*
+* Description:
+* This file defines the globals and the hardware that the firmware files under
+* test expect from the rest of the firmware (Globals.h, the interrupts, etc.).
+* The tests set 'count32' themselves as they play back a trace.
+*******************************************************************************/
+
+#include "Main_Includes.h"
+
+//Registers (see stub/p24EP256MC206.h)
+volatile PORTABITS PORTAbits;
+volatile unsigned int DMA0CON, DMA0REQ, DMA0PAD, DMA0CNT;
+volatile unsigned int DMA0STAL, DMA0STAH, DMA0STBL, DMA0STBH;
+volatile DMA0CONBITS DMA0CONbits;
+volatile DMAPPSBITS DMAPPSbits;
+volatile unsigned int _DMA0IF, _DMA0IE;
+volatile unsigned int ADC1BUF0;
+
+//Globals.h
+volatile UINT32 count32 = 0;
+volatile UINT32 anim_count = 0;
+volatile UINT16 anim_rate = 256;
+volatile UINT16 anim_period = 0;
+volatile UINT8 anim_beat = 0;
+
+//ADC_Setup.c
+volatile UINT16 adc_sample[4];
+
+void __delay32(unsigned long cycles)
+{
+}
@@ -0,0 +1,369 @@
+/*******************************************************************************
+* Title: spectrum_test.c
+* Version: 1.0
+* Author: robotros
+* Date: October 19, 2026
+*
+* Description:
+* This program runs the spectrum analyzer in Spectrum.c on a PC.
+*
+* A WAV file (16-bit PCM, mono or stereo, any sample rate) is mixed down to
+* mono, resampled to SPECTRUM_RATE and scaled to 10-bit ADC readings (biased to
+* 512, like the audio input on the table). The readings are written into the
+* ping-pong buffers one at a time, the same way the DMA does it, while
+* Spectrum_Update() is called every ms like the main loop does, and the bar
+* heights of every frame are printed ('.' = 0, then 1 - 9 and A - C for 10 - 12).
+*
+* The tone test passes a sine at the middle of each bar through Spectrum_Window(),
+* Spectrum_FFT() and Spectrum_Bin() and checks that the bar is the loudest one.
+*
+*   spectrum_test <wav>          -> Play a WAV file
+*   spectrum_test -t             -> Tone test, returns 1 if a bar is wrong
+*   spectrum_test -w <wav>       -> Write SWEEP_TIME ms of a log sweep to a WAV
+*******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "Main_Includes.h"
+#include "Grid_Setup.h"
+#include "Spectrum.h"
+
+extern volatile UINT32 count32;
+extern volatile INT16 spectrum_dma[2][SPECTRUM_N];
+extern INT16 spectrum_im[SPECTRUM_N];
+extern const UINT8 spectrum_edge[SPECTRUM_COLUMNS + 1];
+
+//The rate of the samples (Spectrum.h, 250us / ADC_OVERSAMPLE)
+#define SPECTRUM_RATE       16000
+
+//The amplitude of the test tones (ADC counts, the input is +/-512)
+#define TONE_LEVEL          300
+
+//The sweep goes from SWEEP_LOW to SWEEP_HIGH Hz at SWEEP_RATE samples/s
+#define SWEEP_TIME          4000
+#define SWEEP_LOW           100.0
+#define SWEEP_HIGH          7500.0
+#define SWEEP_RATE          44100
+
+/*******************************************************************************
+* Function: Play(UINT16 *sample, UINT32 count)
+*
+* Variables:
+* *sample -> The 10-bit readings at SPECTRUM_RATE
+* count -> The amount of readings
+*
+* Description:
+* This function plays the readings through the DMA buffers and
+* Spectrum_Update() and prints the bars of each frame.
+*******************************************************************************/
+void Play(UINT16 *sample, UINT32 count)
+{
+  const char *digit = ".123456789ABC";
+  UINT8 height[SPECTRUM_COLUMNS];
+  char line[SPECTRUM_COLUMNS + 1];
+  UINT32 n;
+  UINT8 x;
+  UINT8 fill = 0;
+
+  memset(height,0,sizeof(height));
+  line[SPECTRUM_COLUMNS] = 0;
+
+  Spectrum_Init();
+  DMAPPSbits.PPST0 = 0;
+
+  for (n = 0;n < count;n++)
+  {
+    //The main loop runs once a ms
+    if (!(n % (SPECTRUM_RATE / 1000)))
+    {
+      count32 = n / (SPECTRUM_RATE / 1000);
+
+      if (Spectrum_Update(height))
+      {
+        for (x = 0;x < SPECTRUM_COLUMNS;x++)
+          line[x] = digit[height[x]];
+
+        printf("%6lu ms  %s\n",(unsigned long) count32,line);
+      }
+    }
+
+    //The DMA switches buffers and sets its flag every SPECTRUM_N samples
+    spectrum_dma[DMAPPSbits.PPST0][fill] = sample[n];
+
+    if (++fill >= SPECTRUM_N)
+    {
+      fill = 0;
+      DMAPPSbits.PPST0 ^= 1;
+      _DMA0IF = 1;
+    }
+  }
+}
+
+/*******************************************************************************
+* Function: Read_U16(UINT8 *p) / Read_U32(UINT8 *p)
+*
+* Variables:
+* *p -> A little endian value in the WAV file
+*
+* Description:
+* Return the value.
+*******************************************************************************/
+UINT16 Read_U16(UINT8 *p)
+{
+  return p[0] | (p[1] << 8);
+}
+
+UINT32 Read_U32(UINT8 *p)
+{
+  return p[0] | (p[1] << 8) | ((UINT32) p[2] << 16) | ((UINT32) p[3] << 24);
+}
+
+/*******************************************************************************
+* Function: Play_WAV(const char *name)
+*
+* Variables:
+* *name -> The WAV file
+*
+* Description:
+* This function reads a 16-bit PCM WAV file, converts it to 10-bit readings at
+* SPECTRUM_RATE and plays it. Returns 0 if the file can't be read.
+*******************************************************************************/
+UINT8 Play_WAV(const char *name)
+{
+  FILE *file;
+  UINT8 header[12];
+  UINT8 chunk[8];
+  UINT8 format[16];
+  UINT8 *data = 0;
+  UINT16 *sample;
+  UINT32 size;
+  UINT32 frames = 0;
+  UINT32 count,n,i;
+  UINT16 channels = 0;
+  UINT32 rate = 0;
+  double at,mix[2];
+  INT32 value;
+  UINT8 c,k;
+
+  file = fopen(name,"rb");
+
+  if (!file)
+    return 0;
+
+  if ((fread(header,1,12,file) != 12) || memcmp(header,"RIFF",4) || memcmp(header + 8,"WAVE",4))
+  {
+    fclose(file);
+    return 0;
+  }
+
+  //Find the "fmt " and "data" chunks
+  while (!data && (fread(chunk,1,8,file) == 8))
+  {
+    size = Read_U32(chunk + 4);
+
+    if (!memcmp(chunk,"fmt ",4) && (size >= 16))
+    {
+      if (fread(format,1,16,file) != 16)
+        break;
+
+      fseek(file,size - 16 + (size & 1),SEEK_CUR);
+
+      channels = Read_U16(format + 2);
+      rate = Read_U32(format + 4);
+
+      if ((Read_U16(format) != 1) || (Read_U16(format + 14) != 16) || !channels || (channels > 2))
+      {
+        printf("%s is not 16-bit PCM mono or stereo\n",name);
+        break;
+      }
+    }
+    else if (!memcmp(chunk,"data",4) && channels)
+    {
+      data = malloc(size);
+
+      if (data)
+        frames = fread(data,1,size,file) / (2 * channels);
+    }
+    else
+      fseek(file,size + (size & 1),SEEK_CUR);
+  }
+
+  fclose(file);
+
+  if (!data)
+    return 0;
+
+  printf("%s: %u channel(s), %lu Hz, %lu ms\n",name,channels,(unsigned long) rate,
+         (unsigned long) ((double) frames * 1000 / rate));
+
+  //Mix down, resample (linear) and scale +/-32768 to +/-512
+  count = (double) frames * SPECTRUM_RATE / rate;
+  sample = malloc(count * sizeof(UINT16));
+
+  for (n = 0;n < count;n++)
+  {
+    at = (double) n * rate / SPECTRUM_RATE;
+    i = (UINT32) at;
+
+    for (k = 0;k < 2;k++)
+    {
+      mix[k] = 0;
+
+      for (c = 0;c < channels;c++)
+        mix[k] += (INT16) Read_U16(data + 2 * (((i + k < frames) ? (i + k) : i) * channels + c));
+    }
+
+    value = 512 + (INT32) ((mix[0] + (mix[1] - mix[0]) * (at - i)) / channels / 64);
+    sample[n] = (value < 0) ? 0 : ((value > 1023) ? 1023 : value);
+  }
+
+  Play(sample,count);
+
+  free(sample);
+  free(data);
+
+  return 1;
+}
+
+/*******************************************************************************
+* Function: Write_Sweep(const char *name)
+*
+* Variables:
+* *name -> The WAV file
+*
+* Description:
+* This function writes SWEEP_TIME ms of a log sweep from SWEEP_LOW to SWEEP_HIGH
+* Hz as a 16-bit mono WAV file. Returns 0 if the file can't be written.
+*******************************************************************************/
+UINT8 Write_Sweep(const char *name)
+{
+  FILE *file;
+  UINT32 count = (double) SWEEP_RATE * SWEEP_TIME / 1000;
+  UINT32 n;
+  UINT8 header[44];
+  double t,phase;
+  INT16 value;
+
+  file = fopen(name,"wb");
+
+  if (!file)
+    return 0;
+
+  memcpy(header,"RIFF\0\0\0\0WAVEfmt \x10\0\0\0\x01\0\x01\0\0\0\0\0\0\0\0\0\x02\0\x10\0data\0\0\0\0",44);
+
+  for (n = 0;n < 4;n++)
+  {
+    header[4 + n] = ((36 + count * 2) >> (8 * n)) & 0xFF;
+    header[24 + n] = (SWEEP_RATE >> (8 * n)) & 0xFF;
+    header[28 + n] = ((SWEEP_RATE * 2) >> (8 * n)) & 0xFF;
+    header[40 + n] = ((count * 2) >> (8 * n)) & 0xFF;
+  }
+
+  fwrite(header,1,44,file);
+
+  for (n = 0;n < count;n++)
+  {
+    //The phase of an exponential sweep is the integral of its frequency
+    t = (double) n / SWEEP_RATE;
+    phase = 2 * M_PI * SWEEP_LOW * (SWEEP_TIME / 1000.0) / log(SWEEP_HIGH / SWEEP_LOW) *
+            (exp(t / (SWEEP_TIME / 1000.0) * log(SWEEP_HIGH / SWEEP_LOW)) - 1);
+    value = 16000 * sin(phase);
+
+    fputc(value & 0xFF,file);
+    fputc((value >> 8) & 0xFF,file);
+  }
+
+  fclose(file);
+
+  return 1;
+}
+
+/*******************************************************************************
+* Function: Tone_Test(void)
+*
+* Variables:
+* N/A
+*
+* Description:
+* This function passes a tone at the middle of each bar through the FFT and
+* checks that the bar is louder than all of the others. Returns the amount of
+* bars that failed.
+*******************************************************************************/
+UINT8 Tone_Test(void)
+{
+  INT16 re[SPECTRUM_N];
+  INT16 im[SPECTRUM_N];
+  UINT8 level[SPECTRUM_COLUMNS];
+  UINT8 fail = 0;
+  UINT8 x,peak;
+  UINT16 i;
+  double freq;
+
+  for (x = 0;x < SPECTRUM_COLUMNS;x++)
+  {
+    freq = (spectrum_edge[x] + spectrum_edge[x + 1] - 1) / 2.0 * SPECTRUM_RATE / SPECTRUM_N;
+
+    for (i = 0;i < SPECTRUM_N;i++)
+      re[i] = 512 + (INT16) lround(TONE_LEVEL * sin(2 * M_PI * freq * i / SPECTRUM_RATE + x));
+
+    Spectrum_Window(re,im);
+    Spectrum_FFT(re,im);
+    Spectrum_Bin(re,im,level);
+
+    //The bar must be louder than every other bar
+    peak = 0;
+
+    for (i = 0;i < SPECTRUM_COLUMNS;i++)
+    {
+      if ((i != x) && (level[i] >= level[x]))
+        peak = 1;
+    }
+
+    printf("  bar %2u  %6.0f Hz  level %2u%s\n",x,freq,level[x],peak ? "  FAIL" : "");
+
+    fail += peak;
+  }
+
+  return fail;
+}
+
+int main(int argc, char **argv)
+{
+  if ((argc > 1) && !strcmp(argv[1],"-t"))
+  {
+    printf("tones at %u ADC counts\n",TONE_LEVEL);
+
+    return Tone_Test() ? 1 : 0;
+  }
+
+  if ((argc > 2) && !strcmp(argv[1],"-w"))
+  {
+    if (!Write_Sweep(argv[2]))
+    {
+      printf("can't write %s\n",argv[2]);
+      return 2;
+    }
+
+    return 0;
+  }
+
+  if (argc > 1)
+  {
+    if (!Play_WAV(argv[1]))
+    {
+      printf("can't read %s\n",argv[1]);
+      return 2;
+    }
+
+    return 0;
+  }
+
+  printf("usage: spectrum_test <wav>\n"
+         "       spectrum_test -t\n"
+         "       spectrum_test -w <wav>\n");
+
+  return 2;
+}
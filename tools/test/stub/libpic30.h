@@ -0,0 +1,17 @@
+/*******************************************************************************
+* Title: libpic30.h (host stand-in)
+* Version: 1.0
+* Author: robotros
+* Date: October 19, 2026
+*
+* Description:
+* This file replaces the XC16 library header when the firmware files under test
+* are built on a PC. The delays are defined in host.c and return right away.
+*******************************************************************************/
+
+#ifndef LIBPIC30_H
+#define LIBPIC30_H
+
+void __delay32(unsigned long cycles);
+
+#endif
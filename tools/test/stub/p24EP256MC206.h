@@ -0,0 +1,44 @@
+/*******************************************************************************
+* Title: p24EP256MC206.h (host stand-in)
+* Version: 1.0
+* Author: robotros
+* Date: October 19, 2026
+*
+* Description:
+* This file replaces the Microchip device header when the firmware files under
+* test are built on a PC. Only the registers that those files touch are declared,
+* they are defined in host.c and do nothing on their own.
+*******************************************************************************/
+
+#ifndef P24EP256MC206_H
+#define P24EP256MC206_H
+
+//MSGEQ7_Setup.c (MSG_STROBE, MSG_RESET)
+typedef struct
+{
+  unsigned RA11:1;
+  unsigned RA12:1;
+} PORTABITS;
+
+extern volatile PORTABITS PORTAbits;
+
+//Spectrum.c (DMA channel 0). The tests fill the DMA buffers themselves and set
+//PPST0 and the DMA0IF flag the way the DMA does.
+typedef struct
+{
+  unsigned CHEN:1;
+} DMA0CONBITS;
+
+typedef struct
+{
+  unsigned PPST0:1;
+} DMAPPSBITS;
+
+extern volatile unsigned int DMA0CON, DMA0REQ, DMA0PAD, DMA0CNT;
+extern volatile unsigned int DMA0STAL, DMA0STAH, DMA0STBL, DMA0STBH;
+extern volatile DMA0CONBITS DMA0CONbits;
+extern volatile DMAPPSBITS DMAPPSbits;
+extern volatile unsigned int _DMA0IF, _DMA0IE;
+extern volatile unsigned int ADC1BUF0;
+
+#endif
@@ -0,0 +1,272 @@
+/*******************************************************************************
+* Title: tempo_test.c
+* Version: 1.0
+* Author: robotros
+* Date: October 19, 2026
+*
+* Description:
+* This program plays the band levels of a piece of music through the beat
+* tracking in MSGEQ7_Setup.c (MSGEQ7_Tempo(), MSGEQ7_Tempo_Update() and
+* MSGEQ7_Beat()) on a PC, the same way the VU modes call it on the table, and
+* prints the beats and the tempo that it found.
+*
+* The levels either come from a trace that was recorded on the table with
+* TEMPO_TRACE set in MSGEQ7_Setup.h (the UART output can be saved as it is,
+* any line that doesn't start with "T " is skipped), or from a made up drum
+* pattern (kick on every beat, snare on every other beat and a hi-hat on every
+* half beat, with some timing jitter and noise).
+*
+*   tempo_test [-v] <trace> [bpm]  -> Play a recorded trace
+*   tempo_test [-v] -s <bpm>       -> Play SYNTH_TIME ms of the drum pattern
+*
+* With a bpm, the program returns 1 if the tempo at the end isn't within
+* TEMPO_TOLERANCE % of it. -v prints every beat.
+*******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "Main_Includes.h"
+#include "MSGEQ7_Setup.h"
+
+extern volatile UINT32 count32;
+extern UINT16 beat_bpm;
+extern UINT8 beat_strength;
+
+//How far (%) the tempo that is found may be from the expected one
+#define TEMPO_TOLERANCE     3
+
+//The length of the drum pattern (ms). The bands are read every 3.5ms.
+#define SYNTH_TIME          30000
+
+UINT8 verbose = 0;
+UINT16 beats[2] = {0,0};
+UINT32 lock_time = 0;
+
+/*******************************************************************************
+* Function: Play(UINT32 time, UINT16 *level)
+*
+* Variables:
+* time -> When the levels were read (ms)
+* *level -> The seven band levels (0 - 31)
+*
+* Description:
+* This function passes one reading to the beat tracking and counts the beats
+* that come out of it.
+*******************************************************************************/
+void Play(UINT32 time, UINT16 *level)
+{
+  static UINT16 cursor = 0;
+  UINT8 beat;
+
+  count32 = time;
+
+  MSGEQ7_Tempo(level);
+
+  beat = MSGEQ7_Beat(&cursor);
+
+  if (!beat)
+    return;
+
+  if (beat & BEAT_KICK)
+    beats[0]++;
+
+  if (beat & BEAT_SNARE)
+    beats[1]++;
+
+  if (beat_bpm && !lock_time)
+    lock_time = time;
+
+  if (verbose)
+    printf("%8lu ms  %s%s  strength %3u  tempo %3u BPM\n",(unsigned long) time,
+           (beat & BEAT_KICK) ? "kick " : "     ",(beat & BEAT_SNARE) ? "snare" : "     ",
+           beat_strength,beat_bpm);
+}
+
+/*******************************************************************************
+* Function: Play_Trace(const char *name)
+*
+* Variables:
+* *name -> The trace file
+*
+* Description:
+* This function plays every "T <count32> <level0> ... <level6>" line of a trace
+* that was recorded with TEMPO_TRACE. Returns 0 if the file can't be read.
+*******************************************************************************/
+UINT8 Play_Trace(const char *name)
+{
+  FILE *file;
+  char line[128];
+  unsigned long time;
+  unsigned int l[7];
+  UINT16 level[7];
+  UINT8 i;
+
+  file = fopen(name,"r");
+
+  if (!file)
+    return 0;
+
+  while (fgets(line,sizeof(line),file))
+  {
+    if (sscanf(line,"T %lu %u %u %u %u %u %u %u",&time,&l[0],&l[1],&l[2],&l[3],
+               &l[4],&l[5],&l[6]) != 8)
+      continue;
+
+    for (i = 0;i < 7;i++)
+      level[i] = l[i];
+
+    Play(time,level);
+  }
+
+  fclose(file);
+
+  return 1;
+}
+
+/*******************************************************************************
+* Function: Noise(void)
+*
+* Variables:
+* N/A
+*
+* Description:
+* Returns a made up noise value from 0 - 3. The sequence is the same every run.
+*******************************************************************************/
+UINT8 Noise(void)
+{
+  static UINT32 seed = 12345;
+
+  seed = seed * 1103515245UL + 12345;
+
+  return (seed >> 16) & 0x03;
+}
+
+/*******************************************************************************
+* Function: Hit(double since, double height, double decay)
+*
+* Variables:
+* since -> The time since the drum was hit (ms)
+* height -> The level the hit adds at first
+* decay -> How quickly it dies away (ms)
+*
+* Description:
+* Returns how much a drum hit adds to the level of a band.
+*******************************************************************************/
+double Hit(double since, double height, double decay)
+{
+  if (since < 0)
+    return 0;
+
+  return height * exp(-since / decay);
+}
+
+/*******************************************************************************
+* Function: Play_Pattern(UINT16 bpm)
+*
+* Variables:
+* bpm -> The tempo of the drum pattern
+*
+* Description:
+* This function plays SYNTH_TIME ms of a drum pattern at 'bpm'. Each beat is
+* moved by up to +/- 6ms so the tempo isn't perfect.
+*******************************************************************************/
+void Play_Pattern(UINT16 bpm)
+{
+  double period = 60000.0 / bpm;
+  double t,since,hit;
+  double band[7];
+  INT32 n,beat;
+  UINT16 level[7];
+  UINT8 i;
+
+  for (n = 0;(t = n * 3.5) < SYNTH_TIME;n++)
+  {
+    //The last beat and when it was hit
+    beat = (INT32) (t / period);
+    hit = beat * period + (((beat * 7) % 13) - 6);
+
+    if (hit > t)
+    {
+      beat--;
+      hit = beat * period + (((beat * 7) % 13) - 6);
+    }
+
+    since = t - hit;
+
+    for (i = 0;i < 7;i++)
+      band[i] = 6 + Noise();
+
+    //Kick on every beat, snare on every other beat
+    band[0] += Hit(since,20,90);
+    band[1] += Hit(since,18,70);
+
+    if (beat & 0x01)
+    {
+      band[3] += Hit(since,16,60);
+      band[4] += Hit(since,18,60);
+      band[5] += Hit(since,14,50);
+    }
+
+    //A bass line that moves every beat, and the hi-hat on every half beat
+    band[2] += 6 + ((beat * 5) % 7);
+    band[6] += Hit(fmod(since,period / 2),10,25);
+
+    for (i = 0;i < 7;i++)
+      level[i] = (band[i] > 31) ? 31 : (UINT16) band[i];
+
+    Play((UINT32) t,level);
+  }
+}
+
+int main(int argc, char **argv)
+{
+  UINT16 expect = 0;
+  int arg = 1;
+
+  if ((argc > arg) && !strcmp(argv[arg],"-v"))
+  {
+    verbose = 1;
+    arg++;
+  }
+
+  if ((argc > (arg + 1)) && !strcmp(argv[arg],"-s"))
+  {
+    expect = atoi(argv[arg + 1]);
+    printf("drum pattern at %u BPM\n",expect);
+    Play_Pattern(expect);
+  }
+  else if (argc > arg)
+  {
+    if (argc > (arg + 1))
+      expect = atoi(argv[arg + 1]);
+
+    printf("%s\n",argv[arg]);
+
+    if (!Play_Trace(argv[arg]))
+    {
+      printf("can't read %s\n",argv[arg]);
+      return 2;
+    }
+  }
+  else
+  {
+    printf("usage: tempo_test [-v] <trace> [bpm]\n"
+           "       tempo_test [-v] -s <bpm>\n");
+    return 2;
+  }
+
+  printf("  %u kicks, %u snares, tempo %u BPM (found after %lu ms)\n",beats[0],beats[1],
+         beat_bpm,(unsigned long) lock_time);
+
+  if (expect && ((beat_bpm * 100 < expect * (100 - TEMPO_TOLERANCE)) ||
+                 (beat_bpm * 100 > expect * (100 + TEMPO_TOLERANCE))))
+  {
+    printf("  FAIL, expected %u BPM\n",expect);
+    return 1;
+  }
+
+  return 0;
+}